@@ -6,7 +6,7 @@ TEMPLATE = app
 TARGET = FPIControl
 DESTDIR = ./debug
 QT += core widgets gui charts
-CONFIG += debug
+CONFIG += debug c++2a
 DEFINES += _WINDOWS WIN64 QT_DEPRECATED_WARNINGS QT_WIDGETS_LIB
 INCLUDEPATH += . \
     ./debug \
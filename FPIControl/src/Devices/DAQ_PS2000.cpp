@@ -13,17 +13,10 @@ daq_PS2000::daq_PS2000(QObject *parent) :
 	daq(parent,
 		{ 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000 },
 		{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 },
-		200e6 // this is only valid for the 2205, needs to be changed, when an other model is used
+		*findModelDescriptor(PS2000_MODELS, (int)PS2000_TYPE::MODEL_PS2205)	// until the connected model is known
 	) {
 	m_acquisitionParameters.timebaseIndex = m_defaultTimebaseIndex;
 	m_acquisitionParameters.timebase = m_availableTimebases[m_defaultTimebaseIndex];
-	// calculate sampling rates
-	m_availableSamplingRates.resize(m_availableTimebases.size());
-	std::transform(m_availableTimebases.begin(), m_availableTimebases.end(), m_availableSamplingRates.begin(),
-		[this](int timebase) {
-			return this->m_maxSamplingRate / pow(2, timebase);
-		}
-	);
 }
 
 daq_PS2000::~daq_PS2000() {
@@ -32,58 +25,76 @@ daq_PS2000::~daq_PS2000() {
 
 void daq_PS2000::setAcquisitionParameters() {
 
-	int16_t maxChannels = (2 < m_unitOpened.noOfChannels) ? 2 : m_unitOpened.noOfChannels;
+	// streaming and segmented captures are only implemented for the PS2000A
+	m_acquisitionParameters.mode = ACQUISITION_MODE::BLOCK;
+	m_acquisitionParameters.no_of_segments = 1;
 
-	for (gsl::index ch{ 0 }; ch < maxChannels; ch++) {
-		m_unitOpened.channelSettings[ch].enabled = m_acquisitionParameters.channelSettings[ch].enabled;
-		m_unitOpened.channelSettings[ch].coupling = m_acquisitionParameters.channelSettings[ch].coupling;
-		m_unitOpened.channelSettings[ch].range = m_acquisitionParameters.channelSettings[ch].range;
+	// only the settings, which changed since they were applied last, are sent to the scope
+	CONFIGURATION_CHANGES changes = beginConfiguration();
+
+	if (changes.any()) {
+		// the scope has to be re-armed with the new settings
+		discardArmedBlock();
 	}
-	
-	// initialize the ADC
-	set_defaults();
 
-	/* Trigger disabled */
-	ps2000_set_trigger(m_unitOpened.handle, PS2000_NONE, 0, PS2000_RISING, 0, m_acquisitionParameters.auto_trigger_ms);
+	if (changes.channels) {
+		int16_t maxChannels = (2 < m_unitOpened.noOfChannels) ? 2 : m_unitOpened.noOfChannels;
 
-	/*  find the maximum number of samples, the time interval (in time_units),
-	*		 the most suitable time units, and the maximum oversample at the current timebase
-	*/
-	m_acquisitionParameters.oversample = 1;
-	while (!ps2000_get_timebase(
-		m_unitOpened.handle,
-		m_acquisitionParameters.timebase,
-		m_acquisitionParameters.no_of_samples,
-		&m_acquisitionParameters.time_interval,
-		&m_acquisitionParameters.time_units,
-		m_acquisitionParameters.oversample,
-		&m_acquisitionParameters.max_samples)
-		) {
-		m_acquisitionParameters.timebase++;
-	};
+		for (gsl::index ch{ 0 }; ch < maxChannels; ch++) {
+			m_unitOpened.channelSettings[ch].enabled = m_acquisitionParameters.channelSettings[ch].enabled;
+			m_unitOpened.channelSettings[ch].coupling = m_acquisitionParameters.channelSettings[ch].coupling;
+			m_unitOpened.channelSettings[ch].range = m_acquisitionParameters.channelSettings[ch].range;
+		}
+
+		// initialize the ADC
+		set_defaults();
+	}
+
+	if (changes.unit || changes.trigger) {
+		if (m_acquisitionParameters.trigger == TRIGGER_SOURCE::EXTERNAL) {
+			/* Trigger on the rising edge of the external input, the acquisition continues without trigger after the timeout */
+			ps2000_set_trigger(m_unitOpened.handle, PS2000_EXTERNAL, 0, PS2000_RISING, 0, DAQ_TRIGGER_TIMEOUT);
+		} else {
+			/* Trigger disabled */
+			ps2000_set_trigger(m_unitOpened.handle, PS2000_NONE, 0, PS2000_RISING, 0, m_acquisitionParameters.auto_trigger_ms);
+		}
+	}
+
+	if (changes.timebase) {
+		/*  find the maximum number of samples, the time interval (in time_units),
+		*		 the most suitable time units, and the maximum oversample at the current timebase
+		*/
+		m_acquisitionParameters.oversample = 1;
+		TIMEBASE_INFO timebase = getTimebase(m_acquisitionParameters.timebase, m_acquisitionParameters.no_of_samples);
+		m_acquisitionParameters.timebase = timebase.timebase;
+		m_acquisitionParameters.time_interval = timebase.time_interval;
+		m_acquisitionParameters.time_units = timebase.time_units;
+		m_acquisitionParameters.max_samples = timebase.max_samples;
+	}
+
+	commitConfiguration();
 
 	emit acquisitionParametersChanged(m_acquisitionParameters);
 }
 
-std::array<std::vector<int32_t>, PS2000_MAX_CHANNELS> daq_PS2000::collectBlockData() {
+DAQ_BLOCK daq_PS2000::collectBlockData() {
 
 	int32_t times[DAQ_BUFFER_SIZE];
 
-	/* Start collecting data,
+	/* Start collecting data, unless a block was armed already,
 	*  wait for completion */
-	ps2000_run_block(
-		m_unitOpened.handle,
-		m_acquisitionParameters.no_of_samples,
-		m_acquisitionParameters.timebase,
-		m_acquisitionParameters.oversample,
-		&m_acquisitionParameters.time_indisposed_ms
-	);
-
-	while (!ps2000_ready(m_unitOpened.handle)) {
-		std::this_thread::sleep_for(10ms);
+	if (!m_blockArmed) {
+		startBlock();
 	}
+	m_blockArmed = false;
+
+	// a negative value means, that the device was lost
+	bool ready = waitForBlock([this]() { return (int)ps2000_ready(m_unitOpened.handle); });
 
 	ps2000_stop(m_unitOpened.handle);
+	if (!ready) {
+		return DAQ_BLOCK{};
+	}
 
 	/* Should be done now...
 	*  get the times (in nanoseconds)
@@ -102,17 +113,18 @@ std::array<std::vector<int32_t>, PS2000_MAX_CHANNELS> daq_PS2000::collectBlockDa
 		m_acquisitionParameters.no_of_samples
 	);
 
+	// the block has to take the timestamps before the next one is armed,
+	// the samples are converted afterwards, while the next block is captured
+	DAQ_BLOCK block = prepareBlock();
+	armNextBlock();
 
-	// create vector of voltage values
-	std::array<std::vector<int32_t>, PS2000_MAX_CHANNELS> values;
-	for (gsl::index i{ 0 }; i < m_acquisitionParameters.no_of_samples; i++) {
-		for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
-			if (m_unitOpened.channelSettings[ch].enabled) {
-				values[ch].push_back(adc_to_mv(m_unitOpened.channelSettings[ch].values[i], m_unitOpened.channelSettings[ch].range));
-			}
+	// convert to voltage values
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		if (m_unitOpened.channelSettings[ch].enabled) {
+			convertChannel(ch, m_unitOpened.channelSettings[ch].values);
 		}
 	}
-	return values;
+	return block;
 }
 
 void daq_PS2000::setOutputVoltage(double voltage) {
@@ -130,10 +142,6 @@ void daq_PS2000::setOutputVoltage(double voltage) {
 	);
 }
 
-double daq_PS2000::getCurrentSamplingRate() {
-	return this->m_maxSamplingRate / pow(2, m_acquisitionParameters.timebase);
-}
-
 /*
  * Public slots
  */
@@ -159,6 +167,8 @@ void daq_PS2000::disconnect() {
 			timer->stop();
 			m_acquisitionRunning = false;
 		}
+		discardArmedBlock();
+		invalidateConfiguration();
 		ps2000_close_unit(m_unitOpened.handle);
 		m_unitOpened.handle = NULL;
 		m_isConnected = false;
@@ -222,119 +232,11 @@ void daq_PS2000::get_info(void) {
 			printf("%s: %s\n", description[i], line);
 		}
 
-		switch (variant) {
-			case (int)PS2000_TYPE::MODEL_PS2104:
-				m_unitOpened.model = (int)PS2000_TYPE::MODEL_PS2104;
-				m_unitOpened.firstRange = PS2000_100MV;
-				m_unitOpened.lastRange = PS2000_20V;
-				m_unitOpened.maxTimebase = PS2104_MAX_TIMEBASE;
-				m_unitOpened.timebases = m_unitOpened.maxTimebase;
-				m_unitOpened.noOfChannels = 1;
-				m_unitOpened.hasAdvancedTriggering = false;
-				m_unitOpened.hasSignalGenerator = false;
-				m_unitOpened.hasEts = true;
-				m_unitOpened.hasFastStreaming = false;
-				break;
-
-			case (int)PS2000_TYPE::MODEL_PS2105:
-				m_unitOpened.model = (int)PS2000_TYPE::MODEL_PS2105;
-				m_unitOpened.firstRange = PS2000_100MV;
-				m_unitOpened.lastRange = PS2000_20V;
-				m_unitOpened.maxTimebase = PS2105_MAX_TIMEBASE;
-				m_unitOpened.timebases = m_unitOpened.maxTimebase;
-				m_unitOpened.noOfChannels = 1;
-				m_unitOpened.hasAdvancedTriggering = false;
-				m_unitOpened.hasSignalGenerator = false;
-				m_unitOpened.hasEts = true;
-				m_unitOpened.hasFastStreaming = false;
-				break;
-
-			case (int)PS2000_TYPE::MODEL_PS2202:
-				m_unitOpened.model = (int)PS2000_TYPE::MODEL_PS2202;
-				m_unitOpened.firstRange = PS2000_100MV;
-				m_unitOpened.lastRange = PS2000_20V;
-				m_unitOpened.maxTimebase = PS2200_MAX_TIMEBASE;
-				m_unitOpened.timebases = m_unitOpened.maxTimebase;
-				m_unitOpened.noOfChannels = 2;
-				m_unitOpened.hasAdvancedTriggering = false;
-				m_unitOpened.hasSignalGenerator = false;
-				m_unitOpened.hasEts = false;
-				m_unitOpened.hasFastStreaming = false;
-				break;
-
-			case (int)PS2000_TYPE::MODEL_PS2203:
-				m_unitOpened.model = (int)PS2000_TYPE::MODEL_PS2203;
-				m_unitOpened.firstRange = PS2000_50MV;
-				m_unitOpened.lastRange = PS2000_20V;
-				m_unitOpened.maxTimebase = PS2000_MAX_TIMEBASE;
-				m_unitOpened.timebases = m_unitOpened.maxTimebase;
-				m_unitOpened.noOfChannels = 2;
-				m_unitOpened.hasAdvancedTriggering = true;
-				m_unitOpened.hasSignalGenerator = true;
-				m_unitOpened.hasEts = true;
-				m_unitOpened.hasFastStreaming = true;
-				break;
-
-			case (int)PS2000_TYPE::MODEL_PS2204:
-				m_unitOpened.model = (int)PS2000_TYPE::MODEL_PS2204;
-				m_unitOpened.firstRange = PS2000_50MV;
-				m_unitOpened.lastRange = PS2000_20V;
-				m_unitOpened.maxTimebase = PS2000_MAX_TIMEBASE;
-				m_unitOpened.timebases = m_unitOpened.maxTimebase;
-				m_unitOpened.noOfChannels = 2;
-				m_unitOpened.hasAdvancedTriggering = true;
-				m_unitOpened.hasSignalGenerator = true;
-				m_unitOpened.hasEts = true;
-				m_unitOpened.hasFastStreaming = true;
-				m_unitOpened.bufferSize = 8000;
-				break;
-
-			case (int)PS2000_TYPE::MODEL_PS2204A:
-				m_unitOpened.model = (int)PS2000_TYPE::MODEL_PS2204A;
-				m_unitOpened.firstRange = PS2000_50MV;
-				m_unitOpened.lastRange = PS2000_20V;
-				m_unitOpened.maxTimebase = PS2000_MAX_TIMEBASE;
-				m_unitOpened.timebases = m_unitOpened.maxTimebase;
-				m_unitOpened.noOfChannels = DUAL_SCOPE;
-				m_unitOpened.hasAdvancedTriggering = true;
-				m_unitOpened.hasSignalGenerator = true;
-				m_unitOpened.hasEts = true;
-				m_unitOpened.hasFastStreaming = true;
-				m_unitOpened.awgBufferSize = 4096;
-				m_unitOpened.bufferSize = 8000;
-				break;
-
-			case (int)PS2000_TYPE::MODEL_PS2205:
-				m_unitOpened.model = (int)PS2000_TYPE::MODEL_PS2205;
-				m_unitOpened.firstRange = PS2000_50MV;
-				m_unitOpened.lastRange = PS2000_20V;
-				m_unitOpened.maxTimebase = PS2000_MAX_TIMEBASE;
-				m_unitOpened.timebases = m_unitOpened.maxTimebase;
-				m_unitOpened.noOfChannels = 2;
-				m_unitOpened.hasAdvancedTriggering = true;
-				m_unitOpened.hasSignalGenerator = true;
-				m_unitOpened.hasEts = true;
-				m_unitOpened.hasFastStreaming = true;
-				m_unitOpened.bufferSize = 16000;
-				break;
-
-			case (int)PS2000_TYPE::MODEL_PS2205A:
-				m_unitOpened.model = (int)PS2000_TYPE::MODEL_PS2205A;
-				m_unitOpened.firstRange = PS2000_50MV;
-				m_unitOpened.lastRange = PS2000_20V;
-				m_unitOpened.maxTimebase = PS2000_MAX_TIMEBASE;
-				m_unitOpened.timebases = m_unitOpened.maxTimebase;
-				m_unitOpened.noOfChannels = DUAL_SCOPE;
-				m_unitOpened.hasAdvancedTriggering = true;
-				m_unitOpened.hasSignalGenerator = true;
-				m_unitOpened.hasEts = true;
-				m_unitOpened.hasFastStreaming = true;
-				m_unitOpened.awgBufferSize = 4096;
-				m_unitOpened.bufferSize = 16000;
-				break;
-
-			default:
-				printf("Unit not supported");
+		const MODEL_DESCRIPTOR* model = findModelDescriptor(PS2000_MODELS, variant);
+		if (model) {
+			applyModel(*model);
+		} else {
+			printf("Unit not supported");
 		}
 
 		m_unitOpened.channelSettings[PS2000_CHANNEL_A].enabled = true;
@@ -364,4 +266,37 @@ void daq_PS2000::get_info(void) {
 		m_unitOpened.timebases = PS2105_MAX_TIMEBASE;
 		m_unitOpened.noOfChannels = SINGLE_CH_SCOPE;
 	}
+}
+
+// find the first timebase, which supports the number of samples
+TIMEBASE_INFO daq_PS2000::findTimebase(int16_t timebase, uint32_t no_of_samples) {
+	TIMEBASE_INFO info;
+	info.timebase = timebase;
+	while (!ps2000_get_timebase(
+		m_unitOpened.handle,
+		info.timebase,
+		no_of_samples,
+		&info.time_interval,
+		&info.time_units,
+		m_acquisitionParameters.oversample,
+		&info.max_samples)
+		) {
+		info.timebase++;
+	};
+	return info;
+}
+
+// start collecting data without waiting for it
+bool daq_PS2000::armBlock() {
+	return ps2000_run_block(
+		m_unitOpened.handle,
+		m_acquisitionParameters.no_of_samples,
+		m_acquisitionParameters.timebase,
+		m_acquisitionParameters.oversample,
+		&m_acquisitionParameters.time_indisposed_ms
+	) != 0;
+}
+
+void daq_PS2000::abortBlock() {
+	ps2000_stop(m_unitOpened.handle);
 }
\ No newline at end of file
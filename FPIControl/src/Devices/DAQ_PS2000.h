@@ -12,7 +12,6 @@
 #include <gsl/gsl>
 #include "ps2000.h"
 #include "daq.h"
-#include "..\circularBuffer.h"
 #include "..\generalmath.h"
 
 #define DAQ_BUFFER_SIZE 	8000
@@ -31,6 +30,19 @@ typedef enum class PS2000Type{
 	MODEL_PS2205A = 0xA205
 } PS2000_TYPE;
 
+// supported models, the sampling rate is halved with every timebase
+constexpr std::array<MODEL_DESCRIPTOR, 8> PS2000_MODELS{ {
+	// model							firstRange		lastRange	maxTimebase				channels	adv. trig.	sig. gen.	ETS		fast str.	AWG		buffer	max. rate
+	{ (int)PS2000_TYPE::MODEL_PS2104,	PS2000_100MV,	PS2000_20V,	PS2104_MAX_TIMEBASE,	1,			false,		false,		true,	false,		0,		0,		50e6 },
+	{ (int)PS2000_TYPE::MODEL_PS2105,	PS2000_100MV,	PS2000_20V,	PS2105_MAX_TIMEBASE,	1,			false,		false,		true,	false,		0,		0,		100e6 },
+	{ (int)PS2000_TYPE::MODEL_PS2202,	PS2000_100MV,	PS2000_20V,	PS2200_MAX_TIMEBASE,	2,			false,		false,		false,	false,		0,		0,		20e6 },
+	{ (int)PS2000_TYPE::MODEL_PS2203,	PS2000_50MV,	PS2000_20V,	PS2000_MAX_TIMEBASE,	2,			true,		true,		true,	true,		0,		0,		40e6 },
+	{ (int)PS2000_TYPE::MODEL_PS2204,	PS2000_50MV,	PS2000_20V,	PS2000_MAX_TIMEBASE,	2,			true,		true,		true,	true,		0,		8000,	100e6 },
+	{ (int)PS2000_TYPE::MODEL_PS2204A,	PS2000_50MV,	PS2000_20V,	PS2000_MAX_TIMEBASE,	DUAL_SCOPE,	true,		true,		true,	true,		4096,	8000,	100e6 },
+	{ (int)PS2000_TYPE::MODEL_PS2205,	PS2000_50MV,	PS2000_20V,	PS2000_MAX_TIMEBASE,	2,			true,		true,		true,	true,		0,		16000,	200e6 },
+	{ (int)PS2000_TYPE::MODEL_PS2205A,	PS2000_50MV,	PS2000_20V,	PS2000_MAX_TIMEBASE,	DUAL_SCOPE,	true,		true,		true,	true,		4096,	16000,	200e6 }
+} };
+
 class daq_PS2000 : public daq {
 	Q_OBJECT
 
@@ -38,11 +50,9 @@ class daq_PS2000 : public daq {
 		explicit daq_PS2000(QObject *parent);
 		~daq_PS2000();
 		void setAcquisitionParameters() override;
-		std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> collectBlockData() override;
+		DAQ_BLOCK collectBlockData() override;
 		void setOutputVoltage(double voltage) override;
 
-		double getCurrentSamplingRate() override;
-
 	public slots:
 		void connect() override;
 		void disconnect() override;
@@ -51,6 +61,10 @@ class daq_PS2000 : public daq {
 		void set_defaults(void) override;
 		void get_info(void) override;
 
+		TIMEBASE_INFO findTimebase(int16_t timebase, uint32_t no_of_samples) override;
+		bool armBlock() override;
+		void abortBlock() override;
+
 		int m_defaultTimebaseIndex{ 10 };
 };
 
@@ -13,21 +13,10 @@ daq_PS2000A::daq_PS2000A(QObject *parent) :
 	daq(parent,
 		{ 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000 },
 		{ 0, 1, 2, 3, 4, 6, 10, 18, 34, 66, 130, 258, 514 },
-		500e6 // this is only valid for the 2405A, needs to be changed, when an other model is used
+		*findModelDescriptor(PS2000A_MODELS, (int)PS2000A_TYPE::MODEL_PS2405A)	// until the connected model is known
 	) {
 	m_acquisitionParameters.timebaseIndex = m_defaultTimebaseIndex;
 	m_acquisitionParameters.timebase = m_availableTimebases[m_defaultTimebaseIndex];
-	// calculate sampling rates
-	m_availableSamplingRates.resize(m_availableTimebases.size());
-	std::transform(m_availableTimebases.begin(), m_availableTimebases.end(), m_availableSamplingRates.begin(),
-		[this](int timebase) {
-			if (timebase < 3) {
-				return this->m_maxSamplingRate / pow(2, timebase);
-			} else {
-				return this->m_maxSamplingRate / (8 * ((double)timebase - 2));
-			}
-		}
-	);
 }
 
 daq_PS2000A::~daq_PS2000A() {
@@ -36,72 +25,123 @@ daq_PS2000A::~daq_PS2000A() {
 
 void daq_PS2000A::setAcquisitionParameters() {
 
-	int16_t maxChannels = (2 < m_unitOpened.noOfChannels) ? 2 : m_unitOpened.noOfChannels;
+	// only the settings, which changed since they were applied last, are sent to the scope
+	CONFIGURATION_CHANGES changes = beginConfiguration();
 
-	for (gsl::index ch{ 0 }; ch < maxChannels; ch++) {
-		m_unitOpened.channelSettings[ch].enabled = m_acquisitionParameters.channelSettings[ch].enabled;
-		m_unitOpened.channelSettings[ch].coupling = m_acquisitionParameters.channelSettings[ch].coupling;
-		m_unitOpened.channelSettings[ch].range = m_acquisitionParameters.channelSettings[ch].range;
+	if (changes.any()) {
+		// the scope has to be re-armed with the new settings
+		stopStreaming();
+		discardArmedBlock();
 	}
 
-	// initialize the ADC
-	set_defaults();
+	if (changes.channels) {
+		int16_t maxChannels = (2 < m_unitOpened.noOfChannels) ? 2 : m_unitOpened.noOfChannels;
 
-	/* Trigger disabled */
-	ps2000aSetSimpleTrigger(
-		m_unitOpened.handle,		// handle
-		NULL,					// enable
-		PS2000A_CHANNEL_A,		// source
-		NULL,					// threshold
-		PS2000A_NONE,			// direction
-		NULL,					// delay
-		NULL
-	);
+		for (gsl::index ch{ 0 }; ch < maxChannels; ch++) {
+			m_unitOpened.channelSettings[ch].enabled = m_acquisitionParameters.channelSettings[ch].enabled;
+			m_unitOpened.channelSettings[ch].coupling = m_acquisitionParameters.channelSettings[ch].coupling;
+			m_unitOpened.channelSettings[ch].range = m_acquisitionParameters.channelSettings[ch].range;
+		}
 
-	/*  find the maximum number of samples, the time interval (in time_units),
-	*		 the most suitable time units, and the maximum oversample at the current timebase
-	*/
-	m_acquisitionParameters.oversample = 1;
+		// initialize the ADC
+		set_defaults();
+	}
 
-	while (ps2000aGetTimebase(
-		m_unitOpened.handle,
-		m_acquisitionParameters.timebase,
-		m_acquisitionParameters.no_of_samples,
-		&m_acquisitionParameters.time_interval,
-		m_acquisitionParameters.oversample,
-		&m_acquisitionParameters.max_samples,
-		0)
-		) {
-		m_acquisitionParameters.timebase++;
-	};
+	if (changes.unit || changes.trigger) {
+		if (m_acquisitionParameters.trigger == TRIGGER_SOURCE::EXTERNAL) {
+			/* Trigger on the rising edge of the external input, the acquisition continues without trigger after the timeout */
+			ps2000aSetSimpleTrigger(
+				m_unitOpened.handle,	// handle
+				1,						// enable
+				PS2000A_EXTERNAL,		// source
+				0,						// threshold
+				PS2000A_RISING,			// direction
+				0,						// delay
+				DAQ_TRIGGER_TIMEOUT		// autoTrigger_ms
+			);
+		} else {
+			/* Trigger disabled */
+			ps2000aSetSimpleTrigger(
+				m_unitOpened.handle,		// handle
+				NULL,					// enable
+				PS2000A_CHANNEL_A,		// source
+				NULL,					// threshold
+				PS2000A_NONE,			// direction
+				NULL,					// delay
+				NULL
+			);
+		}
+	}
+
+	if (changes.segments) {
+		/* Split the memory into one segment per capture */
+		int32_t maxSegmentSamples{ 0 };
+		ps2000aMemorySegments(m_unitOpened.handle, m_acquisitionParameters.no_of_segments, &maxSegmentSamples);
+		// use fewer segments if a block does not fit into a segment
+		while (m_acquisitionParameters.no_of_segments > 1 && maxSegmentSamples < (int32_t)m_acquisitionParameters.no_of_samples) {
+			m_acquisitionParameters.no_of_segments /= 2;
+			ps2000aMemorySegments(m_unitOpened.handle, m_acquisitionParameters.no_of_segments, &maxSegmentSamples);
+		}
+		ps2000aSetNoOfCaptures(m_unitOpened.handle, m_acquisitionParameters.no_of_segments);
+
+		if (m_acquisitionParameters.no_of_segments > 1) {
+			m_segmentOverflow.resize(m_acquisitionParameters.no_of_segments);
+		}
+	}
+
+	// a channel, which is enabled later, needs its buffer as well
+	if ((changes.segments || changes.channels) && m_acquisitionParameters.no_of_segments > 1) {
+		for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+			if (m_unitOpened.channelSettings[ch].enabled) {
+				m_segmentBuffers[ch].resize((size_t)m_acquisitionParameters.no_of_samples * m_acquisitionParameters.no_of_segments);
+			}
+		}
+	}
+
+	if (changes.timebase) {
+		/*  find the maximum number of samples, the time interval (in time_units),
+		*		 the most suitable time units, and the maximum oversample at the current timebase
+		*/
+		m_acquisitionParameters.oversample = 1;
+		TIMEBASE_INFO timebase = getTimebase(m_acquisitionParameters.timebase, m_acquisitionParameters.no_of_samples);
+		m_acquisitionParameters.timebase = timebase.timebase;
+		m_acquisitionParameters.time_interval = timebase.time_interval;
+		m_acquisitionParameters.max_samples = timebase.max_samples;
+	}
+
+	commitConfiguration();
+
+	// the driver selects the sample interval of a stream, which is only known once it runs
+	if (m_isConnected && m_acquisitionParameters.mode == ACQUISITION_MODE::STREAMING) {
+		startStreaming();
+	}
 
 	emit acquisitionParametersChanged(m_acquisitionParameters);
 }
 
-std::array<std::vector<int32_t>, PS2000A_MAX_CHANNELS> daq_PS2000A::collectBlockData() {
+double daq_PS2000A::getCurrentSamplingRate() {
+	if (m_acquisitionParameters.mode == ACQUISITION_MODE::STREAMING && m_streamingRunning) {
+		return m_streamingSamplingRate;
+	}
+	return daq::getCurrentSamplingRate();
+}
 
-	/* Start collecting data,
-	*  wait for completion */
-	ps2000aRunBlock(
-		m_unitOpened.handle,						// handle
-		0,										// noOfPreTriggerSamples
-		m_acquisitionParameters.no_of_samples,	// noOfPostTriggerSamples
-		m_acquisitionParameters.timebase,			// timebase
-		m_acquisitionParameters.oversample,		// oversample
-		&m_acquisitionParameters.time_indisposed_ms,	//timeIndisposedMs
-		0,										// segmentIndex
-		NULL,									// lpReady
-		NULL									// * pParameter
-	);
+DAQ_BLOCK daq_PS2000A::collectBlockData() {
 
-	int16_t ready{ 0 };
-	ps2000aIsReady(m_unitOpened.handle, &ready);
-	while (!ready) {
-		std::this_thread::sleep_for(10ms);
-		ps2000aIsReady(m_unitOpened.handle, &ready);
+	if (m_acquisitionParameters.mode == ACQUISITION_MODE::STREAMING) {
+		return collectStreamingData();
 	}
 
-	for (gsl::index ch{ 0 }; ch < 4; ch++) {
+	if (m_acquisitionParameters.no_of_segments > 1) {
+		return collectSegmentedData();
+	}
+
+	if (!runBlock()) {
+		ps2000aStop(m_unitOpened.handle);
+		return DAQ_BLOCK{};
+	}
+
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
 		ps2000aSetDataBuffers(
 			m_unitOpened.handle,
 			(int16_t)ch,
@@ -120,21 +160,87 @@ std::array<std::vector<int32_t>, PS2000A_MAX_CHANNELS> daq_PS2000A::collectBlock
 		NULL,
 		PS2000A_RATIO_MODE_NONE,
 		0,
-		NULL
+		&m_overflow
 	);
 
 	ps2000aStop(m_unitOpened.handle);
 
-	// create vector of voltage values
-	std::array<std::vector<int32_t>, PS2000A_MAX_CHANNELS> values;
-	for (gsl::index i{ 0 }; i < static_cast<int32_t>(m_acquisitionParameters.no_of_samples); i++) {
-		for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
-			if (m_unitOpened.channelSettings[ch].enabled) {
-				values[ch].push_back(adc_to_mv(buffers[ch * 2][i], m_unitOpened.channelSettings[ch].range));
-			}
+	// the block has to take the timestamps before the next one is armed,
+	// the samples are converted afterwards, while the next block is captured
+	DAQ_BLOCK block = prepareBlock();
+	armNextBlock();
+
+	// convert to voltage values
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		if (m_unitOpened.channelSettings[ch].enabled) {
+			convertChannel(ch, buffers[ch * 2]);
+		}
+	}
+	return block;
+}
+
+// Let the scope downsample the block, so that only the reduced data is transferred.
+// Streamed and segmented blocks are downsampled on the host.
+DAQ_BLOCK daq_PS2000A::collectDownsampledData() {
+	uint32_t ratio = m_acquisitionParameters.downsampling_ratio;
+	DOWNSAMPLING_MODE mode = m_acquisitionParameters.downsampling_mode;
+	if (ratio <= 1 || mode == DOWNSAMPLING_MODE::NONE ||
+		m_acquisitionParameters.mode == ACQUISITION_MODE::STREAMING || m_acquisitionParameters.no_of_segments > 1) {
+		return daq::collectDownsampledData();
+	}
+
+	if (!runBlock()) {
+		ps2000aStop(m_unitOpened.handle);
+		return DAQ_BLOCK{};
+	}
+
+	PS2000A_RATIO_MODE ratioMode = (mode == DOWNSAMPLING_MODE::AGGREGATE) ? PS2000A_RATIO_MODE_AGGREGATE : PS2000A_RATIO_MODE_AVERAGE;
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		ps2000aSetDataBuffers(
+			m_unitOpened.handle,
+			(int16_t)ch,
+			buffers[ch * 2],		// averages or maxima
+			buffers[ch * 2 + 1],	// minima
+			DAQ_BUFFER_SIZE,
+			0,
+			ratioMode
+		);
+	}
+
+	// on return this is the number of downsampled values
+	uint32_t noOfSamples = m_acquisitionParameters.no_of_samples;
+	ps2000aGetValues(
+		m_unitOpened.handle,
+		0,
+		&noOfSamples,
+		ratio,
+		ratioMode,
+		0,
+		&m_overflow
+	);
+
+	ps2000aStop(m_unitOpened.handle);
+
+	// convert to voltage values
+	DAQ_BLOCK block;
+	block.no_of_segments = 1;
+	block.info = prepareBlockInfo();
+	block.info.samplingRate /= ratio;
+	block.info.no_of_samples = noOfSamples;
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		if (!m_unitOpened.channelSettings[ch].enabled) {
+			continue;
+		}
+		m_downsampledData[ch].resize(noOfSamples);
+		convertChannel(ch, buffers[ch * 2], m_downsampledData[ch].span());
+		block.channels[ch] = m_downsampledData[ch].span();
+		if (mode == DOWNSAMPLING_MODE::AGGREGATE) {
+			m_downsampledMin[ch].resize(noOfSamples);
+			convertChannel(ch, buffers[ch * 2 + 1], m_downsampledMin[ch].span());
+			block.channelsMin[ch] = m_downsampledMin[ch].span();
 		}
 	}
-	return values;
+	return block;
 }
 
 void daq_PS2000A::setOutputVoltage(double voltage) {
@@ -157,15 +263,6 @@ void daq_PS2000A::setOutputVoltage(double voltage) {
 	);
 }
 
-double daq_PS2000A::getCurrentSamplingRate() {
-	int16_t timebase = m_acquisitionParameters.timebase;
-	if (timebase < 3) {
-		return this->m_maxSamplingRate / pow(2, timebase);
-	} else {
-		return this->m_maxSamplingRate / (8 * ((double)timebase - 2));
-	}
-}
-
 /*
  * Public slots
  */
@@ -191,6 +288,9 @@ void daq_PS2000A::disconnect() {
 			timer->stop();
 			m_acquisitionRunning = false;
 		}
+		stopStreaming();
+		discardArmedBlock();
+		invalidateConfiguration();
 		ps2000aCloseUnit(m_unitOpened.handle);
 		m_unitOpened.handle = NULL;
 		m_isConnected = false;
@@ -265,21 +365,10 @@ void daq_PS2000A::get_info(void) {
 		}
 
 
-		switch (variant) {
-		case (int)PS2000A_TYPE::MODEL_PS2405A:
-			m_unitOpened.model = (int)PS2000A_TYPE::MODEL_PS2405A;
-			m_unitOpened.firstRange = PS2000A_50MV;
-			m_unitOpened.lastRange = PS2000A_20V;
-			m_unitOpened.noOfChannels = QUAD_SCOPE;
-			m_unitOpened.hasAdvancedTriggering = true;
-			m_unitOpened.hasSignalGenerator = true;
-			m_unitOpened.hasEts = true;
-			m_unitOpened.hasFastStreaming = true;
-			m_unitOpened.awgBufferSize = 4096;
-			m_unitOpened.bufferSize = 16000;
-			break;
-
-		default:
+		const MODEL_DESCRIPTOR* model = findModelDescriptor(PS2000A_MODELS, variant);
+		if (model) {
+			applyModel(*model);
+		} else {
 			printf("Unit not supported");
 		}
 
@@ -310,4 +399,285 @@ void daq_PS2000A::get_info(void) {
 		//m_unitOpened.timebases = PS2105A_MAX_TIMEBASE;
 		//m_unitOpened.noOfChannels = SINGLE_CH_SCOPE;
 	}
+}
+
+// start collecting data without waiting for it
+bool daq_PS2000A::armBlock() {
+	BLOCK_READY_CONTEXT* context{ nullptr };
+	{
+		std::lock_guard<std::mutex> lock(m_blockReadyMutex);
+		m_blockReady = false;
+		m_armGeneration++;
+		context = &m_blockReadyContexts[m_armGeneration % BLOCK_READY_CONTEXTS];
+		*context = { this, m_armGeneration };
+	}
+
+	PICO_STATUS status = ps2000aRunBlock(
+		m_unitOpened.handle,						// handle
+		0,										// noOfPreTriggerSamples
+		m_acquisitionParameters.no_of_samples,	// noOfPostTriggerSamples
+		m_acquisitionParameters.timebase,			// timebase
+		m_acquisitionParameters.oversample,		// oversample
+		&m_acquisitionParameters.time_indisposed_ms,	//timeIndisposedMs
+		0,										// segmentIndex
+		blockReady,								// lpReady
+		context									// * pParameter
+	);
+	return status == PICO_OK;
+}
+
+void daq_PS2000A::abortBlock() {
+	ps2000aStop(m_unitOpened.handle);
+}
+
+// find the first timebase, which supports the number of samples
+TIMEBASE_INFO daq_PS2000A::findTimebase(int16_t timebase, uint32_t no_of_samples) {
+	TIMEBASE_INFO info;
+	info.timebase = timebase;
+	while (ps2000aGetTimebase(
+		m_unitOpened.handle,
+		info.timebase,
+		no_of_samples,
+		&info.time_interval,
+		m_acquisitionParameters.oversample,
+		&info.max_samples,
+		0)
+		) {
+		info.timebase++;
+	};
+	return info;
+}
+
+/* Start collecting data, unless a block was armed already,
+*  wait for completion, returns false if the block was not acquired */
+bool daq_PS2000A::runBlock() {
+	if (!m_blockArmed) {
+		startBlock();
+	}
+	m_blockArmed = false;
+
+	// wait for the driver to notify us, poll the device in case the notification does not arrive
+	bool notified{ false };
+	{
+		std::unique_lock<std::mutex> lock(m_blockReadyMutex);
+		notified = m_blockReadyCondition.wait_until(
+			lock,
+			m_blockStarted + std::chrono::milliseconds(m_acquisitionParameters.time_indisposed_ms) + 100ms,
+			[this]() { return m_blockReady; }
+		);
+	}
+	if (notified) {
+		m_blockCompleted = std::chrono::steady_clock::now();
+		return true;
+	}
+	return waitForBlock([this]() {
+		int16_t ready{ 0 };
+		PICO_STATUS status = ps2000aIsReady(m_unitOpened.handle, &ready);
+		return (status != PICO_OK) ? -1 : (int)ready;
+	});
+}
+
+/****************************************************************************
+* Segmented captures
+*
+* A single run block fills no_of_segments memory segments with consecutive
+* captures, which are transferred with one bulk request. The segments are
+* stored one after another, so that the whole batch is processed at once.
+****************************************************************************/
+DAQ_BLOCK daq_PS2000A::collectSegmentedData() {
+	uint32_t noOfSamples = m_acquisitionParameters.no_of_samples;
+	uint32_t noOfSegments = m_acquisitionParameters.no_of_segments;
+
+	if (!runBlock()) {
+		ps2000aStop(m_unitOpened.handle);
+		return DAQ_BLOCK{};
+	}
+
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		if (!m_unitOpened.channelSettings[ch].enabled) {
+			continue;
+		}
+		// the range of a channel can enable it without configuring the acquisition again,
+		// the buffer is only reallocated then
+		m_segmentBuffers[ch].resize((size_t)noOfSamples * noOfSegments);
+		for (uint32_t segment{ 0 }; segment < noOfSegments; segment++) {
+			ps2000aSetDataBuffer(
+				m_unitOpened.handle,
+				PS2000A_CHANNEL(ch),
+				&m_segmentBuffers[ch][(size_t)segment * noOfSamples],
+				noOfSamples,
+				segment,
+				PS2000A_RATIO_MODE_NONE
+			);
+		}
+	}
+
+	ps2000aGetValuesBulk(
+		m_unitOpened.handle,
+		&noOfSamples,
+		0,						// fromSegmentIndex
+		noOfSegments - 1,		// toSegmentIndex
+		1,						// downSampleRatio
+		PS2000A_RATIO_MODE_NONE,
+		m_segmentOverflow.data()
+	);
+
+	ps2000aStop(m_unitOpened.handle);
+
+	m_overflow = 0;
+	for (auto overflow : m_segmentOverflow) {
+		m_overflow |= overflow;
+	}
+
+	// the block has to take the timestamps before the next one is armed
+	DAQ_BLOCK block = prepareBlock();
+	armNextBlock();
+
+	// convert to voltage values
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		if (m_unitOpened.channelSettings[ch].enabled) {
+			convertChannel(ch, m_segmentBuffers[ch].data());
+		}
+	}
+	return block;
+}
+
+// Called from a driver thread, when ps2000aRunBlock has finished. Aborted or failed captures
+// and captures, which were replaced by a newer one, do not mark the current capture as ready.
+void __stdcall daq_PS2000A::blockReady(int16_t handle, PICO_STATUS status, void *pParameter) {
+	auto context = static_cast<BLOCK_READY_CONTEXT*>(pParameter);
+	auto unit = context->unit;
+	{
+		std::lock_guard<std::mutex> lock(unit->m_blockReadyMutex);
+		if (status != PICO_OK || context->generation != unit->m_armGeneration) {
+			return;
+		}
+		unit->m_blockReady = true;
+	}
+	unit->m_blockReadyCondition.notify_one();
+}
+
+/****************************************************************************
+* Streaming mode
+*
+* The scope samples continuously and the driver hands new samples to
+* streamingReady(), which splits them into blocks of no_of_samples.
+* The callback is only invoked from within ps2000aGetStreamingLatestValues(),
+* so it runs on the acquisition thread and needs no locking. The completed
+* blocks are kept in a ring, which overwrites the oldest unread block: the
+* callback cannot wait for the consumer on the same thread, and the newest
+* data is more relevant for locking.
+****************************************************************************/
+void daq_PS2000A::startStreaming() {
+	if (m_streamingRunning) {
+		return;
+	}
+
+	m_streamingBlocks = std::make_unique<CircularBuffer<int16_t>>(STREAMING_BLOCK_NUMBER, PS2000A_MAX_CHANNELS,
+		m_acquisitionParameters.no_of_samples, OVERFLOW_POLICY::OVERWRITE_OLDEST);
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		if (!m_unitOpened.channelSettings[ch].enabled) {
+			continue;
+		}
+		m_streamingBuffers[ch].resize(STREAMING_BUFFER_SIZE);
+		ps2000aSetDataBuffer(
+			m_unitOpened.handle,
+			PS2000A_CHANNEL(ch),
+			m_streamingBuffers[ch].data(),
+			STREAMING_BUFFER_SIZE,
+			0,
+			PS2000A_RATIO_MODE_NONE
+		);
+	}
+	m_streamingPosition = 0;
+
+	uint32_t sampleInterval = (uint32_t)round(1e9 / daq::getCurrentSamplingRate());
+	m_blockStarted = std::chrono::steady_clock::now();
+	PICO_STATUS status = ps2000aRunStreaming(
+		m_unitOpened.handle,
+		&sampleInterval,			// sample interval, updated by the driver
+		PS2000A_NS,					// time units of the sample interval
+		0,							// maxPreTriggerSamples
+		STREAMING_BUFFER_SIZE,		// maxPostTriggerSamples
+		0,							// autoStop, stream until stopped
+		1,							// downSampleRatio
+		PS2000A_RATIO_MODE_NONE,	// downSampleRatioMode
+		STREAMING_BUFFER_SIZE		// overviewBufferSize
+	);
+	m_streamingRunning = (status == PICO_OK);
+	// the driver writes back the interval it actually samples with
+	m_streamingSamplingRate = (sampleInterval > 0) ? 1e9 / sampleInterval : daq::getCurrentSamplingRate();
+}
+
+void daq_PS2000A::stopStreaming() {
+	if (m_streamingRunning) {
+		ps2000aStop(m_unitOpened.handle);
+		m_streamingRunning = false;
+	}
+}
+
+DAQ_BLOCK daq_PS2000A::collectStreamingData() {
+	startStreaming();
+
+	// fetch new samples until a complete block is available,
+	// the driver only has a few new samples on every call, so poll it slowly meanwhile
+	int16_t** streamingBlock = (m_streamingRunning) ? m_streamingBlocks->getReadBuffer() : nullptr;
+	while (m_streamingRunning && !streamingBlock) {
+		PICO_STATUS status = ps2000aGetStreamingLatestValues(m_unitOpened.handle, streamingReady, this);
+		if (status != PICO_OK && status != PICO_BUSY) {
+			stopStreaming();
+			break;
+		}
+		streamingBlock = m_streamingBlocks->getReadBuffer();
+		if (!streamingBlock) {
+			std::this_thread::sleep_for(1ms);
+		}
+	}
+
+	// convert the oldest unread block to voltage values
+	if (!streamingBlock) {
+		return DAQ_BLOCK{};
+	}
+	m_blockCompleted = std::chrono::steady_clock::now();
+	m_overflow = m_streamingOverflow[streamingBlock - m_streamingBlocks->m_buffers];
+	DAQ_BLOCK block = prepareBlock();
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		if (m_unitOpened.channelSettings[ch].enabled) {
+			convertChannel(ch, streamingBlock[ch]);
+		}
+	}
+	m_streamingBlocks->releaseReadBuffer();
+	return block;
+}
+
+void __stdcall daq_PS2000A::streamingReady(int16_t handle, int32_t noOfSamples, uint32_t startIndex, int16_t overflow,
+	uint32_t triggerAt, int16_t triggered, int16_t autoStop, void *pParameter) {
+	auto unit = static_cast<daq_PS2000A*>(pParameter);
+	uint32_t blockSize = unit->m_acquisitionParameters.no_of_samples;
+
+	gsl::index copied{ 0 };
+	while (copied < noOfSamples) {
+		// the ring drops the oldest block if it is full,
+		// the new samples are only dropped if the oldest block is being read
+		int16_t** block = unit->m_streamingBlocks->getWriteBuffer();
+		if (!block) {
+			unit->m_streamingPosition = 0;
+			return;
+		}
+		// the overflow flags apply to all new samples, so they are kept for every block they end up in
+		int16_t& blockOverflow = unit->m_streamingOverflow[block - unit->m_streamingBlocks->m_buffers];
+		blockOverflow = (unit->m_streamingPosition == 0) ? overflow : (blockOverflow | overflow);
+		uint32_t count = std::min<uint32_t>(noOfSamples - copied, blockSize - unit->m_streamingPosition);
+		for (gsl::index ch{ 0 }; ch < unit->m_unitOpened.noOfChannels; ch++) {
+			if (unit->m_unitOpened.channelSettings[ch].enabled) {
+				std::copy_n(&unit->m_streamingBuffers[ch][startIndex + copied], count, &block[ch][unit->m_streamingPosition]);
+			}
+		}
+		copied += count;
+		unit->m_streamingPosition += count;
+		if (unit->m_streamingPosition == blockSize) {
+			unit->m_streamingPosition = 0;
+			unit->m_streamingBlocks->releaseWriteBuffer();
+		}
+	}
 }
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include <array>
 #include <chrono>
 #include <ctime>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
 
 #include <gsl/gsl>
 #include "ps2000aApi.h"
@@ -20,6 +23,19 @@
 #define DUAL_SCOPE 2					// Dual channel scope
 #define QUAD_SCOPE 4
 
+#define STREAMING_BUFFER_SIZE	1048576		// samples per channel the driver can buffer between two polls
+#define STREAMING_BLOCK_NUMBER	4			// number of completed blocks kept in streaming mode
+#define BLOCK_READY_CONTEXTS	4			// captures, whose late callbacks can still be told apart
+
+class daq_PS2000A;
+
+// Passed to the driver with every capture, so that the callback of an aborted capture
+// is not taken for the one armed afterwards
+typedef struct BLOCK_READY_CONTEXT {
+	daq_PS2000A* unit{ nullptr };
+	uint64_t generation{ 0 };			// number of the capture
+} BLOCK_READY_CONTEXT;
+
 typedef enum class PS2000AType{
 	MODEL_NONE = 0,
 	MODEL_PS2104 = 2104,
@@ -33,6 +49,12 @@ typedef enum class PS2000AType{
 	MODEL_PS2405A = 2405
 } PS2000A_TYPE;
 
+// supported models, the sampling rate is halved up to timebase 2 and decreases linearly afterwards
+constexpr std::array<MODEL_DESCRIPTOR, 1> PS2000A_MODELS{ {
+	// model							firstRange		lastRange	maxTimebase	channels	adv. trig.	sig. gen.	ETS		fast str.	AWG		buffer	max. rate	timebase formula
+	{ (int)PS2000A_TYPE::MODEL_PS2405A,	PS2000A_50MV,	PS2000A_20V,	0,		QUAD_SCOPE,	true,		true,		true,	true,		4096,	16000,	500e6,		TIMEBASE_FORMULA::POWER_OF_TWO_THEN_LINEAR }
+} };
+
 class daq_PS2000A : public daq {
 	Q_OBJECT
 
@@ -40,9 +62,9 @@ class daq_PS2000A : public daq {
 		explicit daq_PS2000A(QObject *parent);
 		~daq_PS2000A();
 		void setAcquisitionParameters() override;
-		std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> collectBlockData() override;
+		DAQ_BLOCK collectBlockData() override;
+		DAQ_BLOCK collectDownsampledData() override;
 		void setOutputVoltage(double voltage) override;
-
 		double getCurrentSamplingRate() override;
 
 	public slots:
@@ -53,9 +75,39 @@ class daq_PS2000A : public daq {
 		void set_defaults(void) override;
 		void get_info(void) override;
 
+		TIMEBASE_INFO findTimebase(int16_t timebase, uint32_t no_of_samples) override;
+		bool armBlock() override;
+		void abortBlock() override;
+		bool runBlock();
+		DAQ_BLOCK collectSegmentedData();
+
+		void startStreaming();
+		void stopStreaming();
+		DAQ_BLOCK collectStreamingData();
+		static void __stdcall blockReady(int16_t handle, PICO_STATUS status, void *pParameter);
+		static void __stdcall streamingReady(int16_t handle, int32_t noOfSamples, uint32_t startIndex, int16_t overflow,
+			uint32_t triggerAt, int16_t triggered, int16_t autoStop, void *pParameter);
+
 		int m_defaultTimebaseIndex{ 12 };
 
 		int16_t buffers[PS2000A_MAX_CHANNEL_BUFFERS][DAQ_BUFFER_SIZE * sizeof(int16_t)]{ 0 };
+
+		// signalled by the driver thread when a block is acquired
+		std::mutex m_blockReadyMutex;
+		std::condition_variable m_blockReadyCondition;
+		bool m_blockReady{ false };
+		uint64_t m_armGeneration{ 0 };		// number of the current capture, guarded by m_blockReadyMutex
+		std::array<BLOCK_READY_CONTEXT, BLOCK_READY_CONTEXTS> m_blockReadyContexts;
+
+		std::array<std::vector<int16_t>, PS2000A_MAX_CHANNELS> m_segmentBuffers;	// all segments of a channel one after another
+		std::vector<int16_t> m_segmentOverflow;
+
+		bool m_streamingRunning{ false };
+		std::array<std::vector<int16_t>, PS2000A_MAX_CHANNELS> m_streamingBuffers;	// buffers the driver streams into
+		std::unique_ptr<CircularBuffer<int16_t>> m_streamingBlocks;	// ring of completed blocks, sized when streaming starts
+		uint32_t m_streamingPosition{ 0 };		// number of samples already written to the current block
+		std::array<int16_t, STREAMING_BLOCK_NUMBER> m_streamingOverflow{ 0 };	// overflow flags of every block in the ring
+		double m_streamingSamplingRate{ 0 };	// [Hz] sampling rate selected by the driver when streaming started
 };
 
 #endif // DAQ_PS2000A_H
\ No newline at end of file
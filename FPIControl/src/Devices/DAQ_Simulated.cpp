@@ -0,0 +1,146 @@
+#include "DAQ_Simulated.h"
+#include <QtWidgets>
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QMainWindow>
+
+/*
+ * Public definitions
+ */
+
+daq_Simulated::daq_Simulated(QObject *parent) :
+	daq(parent,
+		{ 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000 },
+		{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 },
+		SIMULATED_MODEL
+	) {
+	m_acquisitionParameters.timebaseIndex = m_defaultTimebaseIndex;
+	m_acquisitionParameters.timebase = m_availableTimebases[m_defaultTimebaseIndex];
+}
+
+daq_Simulated::~daq_Simulated() {
+	disconnect();
+}
+
+void daq_Simulated::setAcquisitionParameters() {
+
+	int16_t maxChannels = (2 < m_unitOpened.noOfChannels) ? 2 : m_unitOpened.noOfChannels;
+
+	for (gsl::index ch{ 0 }; ch < maxChannels; ch++) {
+		m_unitOpened.channelSettings[ch].enabled = m_acquisitionParameters.channelSettings[ch].enabled;
+		m_unitOpened.channelSettings[ch].coupling = m_acquisitionParameters.channelSettings[ch].coupling;
+		m_unitOpened.channelSettings[ch].range = m_acquisitionParameters.channelSettings[ch].range;
+	}
+
+	// there is no scope memory, but we store the samples in the same buffers as the PS2000
+	if (m_acquisitionParameters.no_of_samples > DAQ_BUFFER_SIZE) {
+		m_acquisitionParameters.no_of_samples = DAQ_BUFFER_SIZE;
+	}
+	m_acquisitionParameters.no_of_segments = 1;
+	m_acquisitionParameters.oversample = 1;
+	m_acquisitionParameters.max_samples = DAQ_BUFFER_SIZE;
+	m_acquisitionParameters.time_interval = (int32_t)(1e9 / getCurrentSamplingRate());	// [ns]
+	m_acquisitionParameters.time_indisposed_ms = 0;
+
+	emit acquisitionParametersChanged(m_acquisitionParameters);
+}
+
+DAQ_BLOCK daq_Simulated::collectBlockData() {
+
+	if (m_acquisitionParameters.trigger == TRIGGER_SOURCE::EXTERNAL) {
+		m_simulation.waitForTrigger();
+	}
+
+	// the samples are available immediately
+	m_blockStarted = std::chrono::steady_clock::now();
+	m_blockCompleted = m_blockStarted;
+	m_overflow = 0;
+	m_simulation.simulate(m_acquisitionParameters.no_of_samples, getCurrentSamplingRate(),
+		[this](uint32_t i, double transmission, double reference) {
+			m_unitOpened.channelSettings[0].values[i] = toAdc(transmission, 0);
+			m_unitOpened.channelSettings[1].values[i] = toAdc(reference, 1);
+		}
+	);
+
+	// convert to voltage values
+	DAQ_BLOCK block = prepareBlock();
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		if (m_unitOpened.channelSettings[ch].enabled) {
+			convertChannel(ch, m_unitOpened.channelSettings[ch].values);
+		}
+	}
+	return block;
+}
+
+void daq_Simulated::setOutputVoltage(double voltage) {
+	m_simulation.setOutputVoltage(voltage);
+}
+
+SIMULATION_PARAMETERS daq_Simulated::getSimulationParameters() {
+	return m_simulation.getParameters();
+}
+
+// restart the simulation, so that the same parameters and seed always produce the same data
+void daq_Simulated::setSimulationParameters(SIMULATION_PARAMETERS simulationParameters) {
+	m_simulation.setParameters(simulationParameters);
+}
+
+/*
+ * Public slots
+ */
+
+void daq_Simulated::connect() {
+	if (!m_isConnected) {
+		get_info();
+		setAcquisitionParameters();
+		m_isConnected = true;
+	}
+	emit(connected(m_isConnected));
+}
+
+void daq_Simulated::disconnect() {
+	if (m_isConnected) {
+		if (timer->isActive()) {
+			timer->stop();
+			m_acquisitionRunning = false;
+		}
+		m_isConnected = false;
+	}
+	emit(connected(m_isConnected));
+}
+
+/*
+ * Private definitions
+ */
+
+/****************************************************************************
+* set_defaults - restore default settings
+****************************************************************************/
+void daq_Simulated::set_defaults(void) {
+	// there is no hardware to configure
+}
+
+void daq_Simulated::get_info(void) {
+	applyModel(SIMULATED_MODEL);
+
+	m_unitOpened.channelSettings[0].enabled = true;
+	m_unitOpened.channelSettings[0].coupling = PS_DC;
+	m_unitOpened.channelSettings[0].range = 8;	// 5 V
+	m_unitOpened.channelSettings[1].enabled = true;
+	m_unitOpened.channelSettings[1].coupling = PS_DC;
+	m_unitOpened.channelSettings[1].range = 8;	// 5 V
+
+	set_defaults();
+}
+
+// Convert a voltage to ADC counts like the scope does, including clipping at the range limits.
+// Like on the scope, only enabled channels can report an overflow.
+int16_t daq_Simulated::toAdc(double mv, gsl::index ch) {
+	double raw = mv * 32767 / m_input_ranges[m_unitOpened.channelSettings[ch].range];
+	if (raw > 32767 || raw < -32767) {
+		if (m_unitOpened.channelSettings[ch].enabled) {
+			m_overflow |= 1 << ch;
+		}
+		raw = (raw > 0) ? 32767 : -32767;
+	}
+	return (int16_t)round(raw);
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef DAQ_SIMULATED_H
+#define DAQ_SIMULATED_H
+
+#include <QMainWindow>
+#include <QtCore/QObject>
+#include <QtWidgets>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <ctime>
+
+#include <gsl/gsl>
+#include "daq.h"
+#include "..\generalmath.h"
+#include "..\cavitySimulation.h"
+
+#define SIMULATED_MAX_CHANNELS 2
+
+// behaves like a PS2205, the ranges are indices into m_input_ranges
+constexpr MODEL_DESCRIPTOR SIMULATED_MODEL{
+	(int)PS_TYPES::MODEL_SIMULATED,	// model
+	0,								// firstRange
+	11,								// lastRange
+	10,								// maxTimebase
+	SIMULATED_MAX_CHANNELS,			// noOfChannels
+	false,							// hasAdvancedTriggering
+	true,							// hasSignalGenerator
+	false,							// hasEts
+	false,							// hasFastStreaming
+	0,								// awgBufferSize
+	DAQ_BUFFER_SIZE,				// bufferSize
+	200e6							// maxSamplingRate
+};
+
+class daq_Simulated : public daq {
+	Q_OBJECT
+
+	public:
+		explicit daq_Simulated(QObject *parent);
+		~daq_Simulated();
+		void setAcquisitionParameters() override;
+		DAQ_BLOCK collectBlockData() override;
+		void setOutputVoltage(double voltage) override;
+
+		SIMULATION_PARAMETERS getSimulationParameters();
+		void setSimulationParameters(SIMULATION_PARAMETERS simulationParameters);
+
+	public slots:
+		void connect() override;
+		void disconnect() override;
+
+	private:
+		void set_defaults(void) override;
+		void get_info(void) override;
+
+		int16_t toAdc(double mv, gsl::index ch);
+
+		int m_defaultTimebaseIndex{ 10 };
+
+		CavitySimulation m_simulation;
+};
+
+#endif // DAQ_SIMULATED_H
\ No newline at end of file
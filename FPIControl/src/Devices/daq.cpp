@@ -13,14 +13,19 @@ daq::daq(QObject *parent) :
 	QObject(parent) {
 }
 
-daq::daq(QObject *parent, std::vector<int32_t> ranges, std::vector<int> timebases, double maxSamplingRate) :
-	QObject(parent), m_input_ranges(ranges), m_availableTimebases(timebases), m_maxSamplingRate(maxSamplingRate) {
+daq::daq(QObject *parent, std::vector<int32_t> ranges, std::vector<int> timebases, const MODEL_DESCRIPTOR& model) :
+	QObject(parent), m_input_ranges(ranges), m_model(model), m_availableTimebases(timebases) {
+	calculateSamplingRates();
 }
 
 std::vector<double> daq::getSamplingRates() {
 	return m_availableSamplingRates;
 }
 
+double daq::getCurrentSamplingRate() {
+	return m_model.samplingRate(m_acquisitionParameters.timebase);
+}
+
 ACQUISITION_PARAMETERS daq::getAcquisitionParameters() {
 	return m_acquisitionParameters;
 }
@@ -28,35 +33,176 @@ ACQUISITION_PARAMETERS daq::getAcquisitionParameters() {
 void daq::setSampleRate(int index) {
 	m_acquisitionParameters.timebaseIndex = index;
 	m_acquisitionParameters.timebase = m_availableTimebases[index];
+	m_configuredDuration = m_acquisitionParameters.no_of_samples / daq::getCurrentSamplingRate();
 	setAcquisitionParameters();
 }
 
 void daq::setCoupling(int coupling, int ch) {
+	if (!isConfigurableChannel(ch)) {
+		return;
+	}
 	m_acquisitionParameters.channelSettings[ch].coupling = coupling;
-	m_unitOpened.channelSettings[ch].coupling = coupling;
-	set_defaults();
+	applyChannelSettings();
 }
 
 void daq::setRange(int index, int ch) {
+	if (!isConfigurableChannel(ch)) {
+		return;
+	}
 	if (index < 9) {
 		m_acquisitionParameters.channelSettings[ch].enabled = true;
-		m_unitOpened.channelSettings[ch].enabled = true;
 		m_acquisitionParameters.channelSettings[ch].range = index + 2;
-		m_unitOpened.channelSettings[ch].range = index + 2;
 	} else if (index == 9) {
 		// set auto range
 	} else {
 		m_acquisitionParameters.channelSettings[ch].enabled = false;
-		m_unitOpened.channelSettings[ch].enabled = false;
 	}
-	set_defaults();
+	applyChannelSettings();
 }
 
 void daq::setNumberSamples(int32_t no_of_samples) {
+	// the GUI echoes the number of samples of an applied plan, which must not become the configured duration
+	if ((uint32_t)no_of_samples != m_acquisitionParameters.no_of_samples) {
+		m_configuredDuration = no_of_samples / daq::getCurrentSamplingRate();
+	}
 	m_acquisitionParameters.no_of_samples = no_of_samples;
 	setAcquisitionParameters();
 }
 
+void daq::setAcquisitionMode(ACQUISITION_MODE mode) {
+	m_acquisitionParameters.mode = mode;
+	// the mode is applied on connecting otherwise
+	if (m_isConnected) {
+		setAcquisitionParameters();
+	}
+}
+
+void daq::setTrigger(TRIGGER_SOURCE trigger) {
+	m_acquisitionParameters.trigger = trigger;
+	// the trigger is applied on connecting otherwise
+	if (m_isConnected) {
+		setAcquisitionParameters();
+	}
+}
+
+// A disabled channel is not transferred and allows faster timebases on the PS2000 series.
+void daq::setChannelEnabled(int ch, bool enabled) {
+	if (!isConfigurableChannel(ch)) {
+		return;
+	}
+	m_acquisitionParameters.channelSettings[ch].enabled = enabled;
+	applyChannelSettings();
+}
+
+void daq::setDownsampling(uint32_t ratio, DOWNSAMPLING_MODE mode) {
+	m_acquisitionParameters.downsampling_ratio = (ratio > 0) ? ratio : 1;
+	m_acquisitionParameters.downsampling_mode = mode;
+	// the device only needs to know about it when transferring the data
+	emit acquisitionParametersChanged(m_acquisitionParameters);
+}
+
+// The live view can only let the device downsample the blocks, if no other consumer needs them at full resolution.
+void daq::setConsumerActive(DAQ_CONSUMER consumer, bool active) {
+	m_activeConsumers[(int)consumer] = active;
+}
+
+// With pipelining enabled a block is captured while the previous one is processed,
+// so the data lags one block behind changes of the output voltage.
+void daq::setPipelining(bool pipelined) {
+	m_pipelined = pipelined;
+	if (!pipelined) {
+		discardArmedBlock();
+	}
+}
+
+// The block duration configured by the user is kept approximately, the tolerance is given in periods.
+// Planning from the configured duration instead of the previous plan keeps repeated plans from drifting.
+// The plan is applied and checked on the device: the fastest timebases are not valid for every combination
+// of enabled channels and segments, in which case the device selects a slower one. The sampling rate is then
+// excluded and the acquisition planned again. If no plan is accepted, the previous configuration is restored
+// and the returned plan has no timebase.
+ACQUISITION_PLAN daq::planAcquisition(double frequency, double tolerance) {
+	uint32_t maxSamples = (m_acquisitionParameters.max_samples > 0) ?
+		std::min<uint32_t>(m_acquisitionParameters.max_samples, DAQ_BUFFER_SIZE) : DAQ_BUFFER_SIZE;
+	if (!(m_configuredDuration > 0)) {
+		m_configuredDuration = m_acquisitionParameters.no_of_samples / getCurrentSamplingRate();
+	}
+	ACQUISITION_PARAMETERS configured = m_acquisitionParameters;
+	std::vector<double> samplingRates = m_availableSamplingRates;
+	ACQUISITION_PLAN plan;
+	do {
+		plan = acquisitionPlanner::plan(frequency, samplingRates, m_configuredDuration, maxSamples, tolerance);
+		if (plan.timebaseIndex < 0) {
+			break;
+		}
+		// a sampling rate of zero does not resolve the modulation
+		samplingRates[plan.timebaseIndex] = 0;
+	} while (!applyAcquisitionPlan(plan));
+
+	if (plan.timebaseIndex < 0) {
+		m_acquisitionParameters = configured;
+		setAcquisitionParameters();
+	}
+	return plan;
+}
+
+// returns false, if the device did not accept the timebase of the plan
+bool daq::applyAcquisitionPlan(const ACQUISITION_PLAN& plan) {
+	if (plan.timebaseIndex < 0 || plan.timebaseIndex >= (int)m_availableTimebases.size()) {
+		return false;
+	}
+	m_acquisitionParameters.timebaseIndex = plan.timebaseIndex;
+	m_acquisitionParameters.timebase = m_availableTimebases[plan.timebaseIndex];
+	m_acquisitionParameters.no_of_samples = plan.no_of_samples;
+	setAcquisitionParameters();
+	// in streaming mode the driver may sample at a different rate than requested
+	double samplingRate = m_availableSamplingRates[plan.timebaseIndex];
+	return m_acquisitionParameters.timebase == m_availableTimebases[plan.timebaseIndex] &&
+		abs(getCurrentSamplingRate() - samplingRate) <= DAQ_SAMPLING_RATE_TOLERANCE * samplingRate;
+}
+
+void daq::setNumberSegments(uint32_t no_of_segments) {
+	m_acquisitionParameters.no_of_segments = (no_of_segments > 0) ? no_of_segments : 1;
+	if (m_isConnected) {
+		setAcquisitionParameters();
+	}
+}
+
+// Acquisition thread only: consumers running there share the blocks acquired for each other,
+// so the scope only captures a new block if the consumer has seen all previous ones.
+const DAQ_BLOCK* daq::acquireBlock(DAQ_CONSUMER consumer) {
+	const DAQ_BLOCK* block = readBlock(consumer, READ_POLICY::NEWEST);
+	if (block || !m_isConnected) {
+		return block;
+	}
+
+	DAQ_BLOCK acquired = collectBlockData();
+	if (std::all_of(acquired.channels.begin(), acquired.channels.end(), [](auto channel) { return channel.empty(); })) {
+		// e.g. no complete block was streamed
+		return nullptr;
+	}
+	m_blocks.getWriteBuffer().block = acquired;
+	m_blocks.releaseWriteBuffer();
+	return readBlock(consumer, READ_POLICY::NEWEST);
+}
+
+const DAQ_BLOCK* daq::readBlock(DAQ_CONSUMER consumer, READ_POLICY policy) {
+	const DAQ_BLOCK_SLOT* slot = m_blocks.getReadBuffer((gsl::index)consumer, policy);
+	return (slot) ? &slot->block : nullptr;
+}
+
+void daq::releaseBlock(DAQ_CONSUMER consumer) {
+	m_blocks.releaseReadBuffer((gsl::index)consumer);
+}
+
+void daq::skipBlocks(DAQ_CONSUMER consumer) {
+	m_blocks.skipPublished((gsl::index)consumer);
+}
+
+uint64_t daq::getSkippedBlocks(DAQ_CONSUMER consumer) {
+	return m_blocks.getSkippedBuffers((gsl::index)consumer);
+}
+
 /*
  * Public slots
  */
@@ -97,21 +243,292 @@ int16_t daq::mv_to_adc(int16_t mv, int16_t ch) {
 	return ((mv * 32767) / m_input_ranges[ch]);
 }
 
+// Wait until the block started by startBlock() is acquired. The driver estimates the acquisition time
+// in time_indisposed_ms, so we only sleep while the block is certainly not ready and poll for the rest.
+// This way short blocks are not rounded up to the sleep granularity. Every poll is a USB request, so the
+// polling only spins shortly and then sleeps in growing steps, e.g. while waiting for the trigger.
+// isReady returns a positive value if the block is ready, zero if not and a negative value on an error.
+// Returns false on an error or if the block is not ready before the deadline.
+bool daq::waitForBlock(std::function<int()> isReady) {
+	auto now = std::chrono::steady_clock::now();
+	auto expected = m_blockStarted + std::chrono::milliseconds(m_acquisitionParameters.time_indisposed_ms);
+	while (now + std::chrono::milliseconds(2) < expected) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		now = std::chrono::steady_clock::now();
+	}
+
+	auto deadline = expected + std::chrono::milliseconds(DAQ_TRIGGER_TIMEOUT + DAQ_BLOCK_TIMEOUT);
+	auto spinUntil = now + std::chrono::microseconds(DAQ_POLL_SPIN_US);
+	auto sleep = std::chrono::microseconds(DAQ_POLL_MIN_SLEEP_US);
+	int ready{ 0 };
+	while ((ready = isReady()) == 0) {
+		now = std::chrono::steady_clock::now();
+		if (now > deadline) {
+			return false;
+		}
+		if (now < spinUntil) {
+			std::this_thread::yield();
+		} else {
+			std::this_thread::sleep_for(sleep);
+			sleep = std::min(2 * sleep, std::chrono::microseconds(DAQ_POLL_MAX_SLEEP_US));
+		}
+	}
+	m_blockCompleted = std::chrono::steady_clock::now();
+	return ready > 0;
+}
+
+// take over the properties of the connected model
+void daq::applyModel(const MODEL_DESCRIPTOR& model) {
+	m_model = model;
+	m_unitOpened.model = model.model;
+	m_unitOpened.firstRange = model.firstRange;
+	m_unitOpened.lastRange = model.lastRange;
+	m_unitOpened.maxTimebase = model.maxTimebase;
+	m_unitOpened.timebases = model.maxTimebase;
+	m_unitOpened.noOfChannels = model.noOfChannels;
+	m_unitOpened.hasAdvancedTriggering = model.hasAdvancedTriggering;
+	m_unitOpened.hasSignalGenerator = model.hasSignalGenerator;
+	m_unitOpened.hasEts = model.hasEts;
+	m_unitOpened.hasFastStreaming = model.hasFastStreaming;
+	m_unitOpened.awgBufferSize = model.awgBufferSize;
+	m_unitOpened.bufferSize = model.bufferSize;
+	calculateSamplingRates();
+}
+
+void daq::calculateSamplingRates() {
+	m_availableSamplingRates.resize(m_availableTimebases.size());
+	std::transform(m_availableTimebases.begin(), m_availableTimebases.end(), m_availableSamplingRates.begin(),
+		[this](int timebase) { return m_model.samplingRate(timebase); }
+	);
+}
+
+// compare the requested parameters with the ones applied last
+CONFIGURATION_CHANGES daq::beginConfiguration() {
+	CONFIGURATION_CHANGES changes;
+	if (!m_configurationApplied) {
+		return changes;
+	}
+	const ACQUISITION_PARAMETERS& requested = m_acquisitionParameters;
+	const ACQUISITION_PARAMETERS& applied = m_appliedParameters;
+
+	changes.unit = false;
+	changes.channels = false;
+	for (gsl::index ch{ 0 }; ch < 2; ch++) {
+		changes.channels |= requested.channelSettings[ch].enabled != applied.channelSettings[ch].enabled
+			|| requested.channelSettings[ch].coupling != applied.channelSettings[ch].coupling
+			|| requested.channelSettings[ch].range != applied.channelSettings[ch].range;
+	}
+	changes.segments = requested.no_of_segments != applied.no_of_segments || requested.no_of_samples != applied.no_of_samples;
+	changes.mode = requested.mode != applied.mode;
+	changes.trigger = requested.trigger != applied.trigger;
+	// the valid timebases depend on the enabled channels and the segment size
+	changes.timebase = requested.timebase != applied.timebase || changes.segments || changes.channels;
+	if (changes.channels || requested.no_of_segments != applied.no_of_segments) {
+		m_timebaseCache.clear();
+	}
+	return changes;
+}
+
+void daq::commitConfiguration() {
+	m_appliedParameters = m_acquisitionParameters;
+	m_configurationApplied = true;
+}
+
+// the device has to be configured completely, e.g. after reconnecting
+void daq::invalidateConfiguration() {
+	m_configurationApplied = false;
+	m_timebaseCache.clear();
+}
+
+// look up the timebase on the device, unless it was done for the same settings before
+TIMEBASE_INFO daq::getTimebase(int16_t timebase, uint32_t no_of_samples) {
+	auto key = std::make_pair(timebase, no_of_samples);
+	auto cached = m_timebaseCache.find(key);
+	if (cached != m_timebaseCache.end()) {
+		return cached->second;
+	}
+	TIMEBASE_INFO info = findTimebase(timebase, no_of_samples);
+	m_timebaseCache.emplace(key, info);
+	return info;
+}
+
+// start the capture of a block
+void daq::startBlock() {
+	m_blockStarted = std::chrono::steady_clock::now();
+	m_blockArmed = armBlock();
+}
+
+// called by the devices after a block was transferred, the conversion follows afterwards
+void daq::armNextBlock() {
+	if (m_pipelined && m_isConnected) {
+		startBlock();
+	}
+}
+
+// only the channels A and B are part of the acquisition parameters
+bool daq::isConfigurableChannel(int ch) {
+	return ch >= 0 && ch < (int)std::size(m_acquisitionParameters.channelSettings) &&
+		(!m_isConnected || ch < m_unitOpened.noOfChannels);
+}
+
+// The changed channel settings are applied in a configuration transaction, which only sends the differences
+// to the device. It also restarts a stream and discards an armed capture, whose samples were taken with the old
+// settings. The settings are applied on connecting otherwise.
+void daq::applyChannelSettings() {
+	if (m_isConnected) {
+		setAcquisitionParameters();
+	} else {
+		emit acquisitionParametersChanged(m_acquisitionParameters);
+	}
+}
+
+// a capture armed with the old settings or output voltage must not be used
+void daq::discardArmedBlock() {
+	if (m_blockArmed) {
+		abortBlock();
+		m_blockArmed = false;
+	}
+}
+
+// Number and timestamps of a block, which was just transferred. The devices call this after the transfer,
+// when m_overflow is set already, and before the next block is armed.
+DAQ_BLOCK_INFO daq::prepareBlockInfo() {
+	DAQ_BLOCK_INFO info;
+	info.sequence = ++m_acquiredBlocks;
+	info.armed = m_blockStarted;
+	info.ready = m_blockCompleted;
+	info.transferred = std::chrono::steady_clock::now();
+	Q_ASSERT(info.armed <= info.ready && info.ready <= info.transferred);
+	info.overflow = m_overflow;
+	info.samplingRate = getCurrentSamplingRate();
+	info.no_of_samples = m_acquisitionParameters.no_of_samples;
+	return info;
+}
+
+// Size the storage of the next block in the ring for the current settings and return a view onto it.
+// The storage only grows, so this does not allocate once the largest block size was used.
+DAQ_BLOCK daq::prepareBlock() {
+	DAQ_BLOCK_SLOT& slot = m_blocks.getWriteBuffer();
+	DAQ_BLOCK block;
+	block.no_of_segments = m_acquisitionParameters.no_of_segments;
+	block.info = prepareBlockInfo();
+	// pad the channels to a multiple of the cache line
+	size_t length = (size_t)m_acquisitionParameters.no_of_samples * m_acquisitionParameters.no_of_segments;
+	size_t stride = ((length * sizeof(int32_t) + 63) / 64) * 64 / sizeof(int32_t);
+	slot.storage.resize(DAQ_MAX_CHANNELS * stride);
+	for (gsl::index ch{ 0 }; ch < DAQ_MAX_CHANNELS; ch++) {
+		if (ch < m_unitOpened.noOfChannels && m_unitOpened.channelSettings[ch].enabled) {
+			slot.channels[ch] = slot.storage.span().subspan(ch * stride, length);
+		} else {
+			slot.channels[ch] = gsl::span<int32_t>();
+		}
+		block.channels[ch] = slot.channels[ch];
+	}
+	return block;
+}
+
+// convert the raw ADC counts of a channel into the block storage
+void daq::convertChannel(gsl::index ch, const int16_t* raw) {
+	convertChannel(ch, raw, m_blocks.getWriteBuffer().channels[ch]);
+}
+
+void daq::convertChannel(gsl::index ch, const int16_t* raw, gsl::span<int32_t> target) {
+	gsl::span<const int16_t> counts{ raw, target.size() };
+	if (m_scale_to_mv) {
+		conversion::adcToMillivolt(counts, target, m_input_ranges[m_unitOpened.channelSettings[ch].range]);
+	} else {
+		conversion::adcToCounts(counts, target);
+	}
+}
+
+// Downsample the block on the host. Devices, which can downsample before
+// the transfer, override this to reduce the amount of data sent over USB.
+DAQ_BLOCK daq::collectDownsampledData() {
+	return downsampleBlock(collectBlockData());
+}
+
+// Downsample the block for the live view on the host, e.g. if the full block is shared with the
+// locking and the scan.
+DAQ_BLOCK daq::downsampleBlock(const DAQ_BLOCK& block) {
+	uint32_t ratio = m_acquisitionParameters.downsampling_ratio;
+	DOWNSAMPLING_MODE mode = m_acquisitionParameters.downsampling_mode;
+	if (ratio <= 1 || mode == DOWNSAMPLING_MODE::NONE) {
+		return block;
+	}
+
+	// only the first segment is downsampled
+	DAQ_BLOCK downsampled;
+	for (gsl::index ch{ 0 }; ch < DAQ_MAX_CHANNELS; ch++) {
+		auto channel = block.channels[ch].first(block.channels[ch].size() / block.no_of_segments);
+		size_t length = channel.size() / ratio;
+		if (length == 0) {
+			continue;
+		}
+		m_downsampledData[ch].resize(length);
+		m_downsampledMin[ch].resize(length);
+		for (gsl::index i{ 0 }; i < (gsl::index)length; i++) {
+			REDUCE_STATS stats = reduction::reduceStats(channel.subspan(i * ratio, ratio));
+			if (mode == DOWNSAMPLING_MODE::AVERAGE) {
+				m_downsampledData[ch][i] = (int32_t)(stats.sum / ratio);
+			} else {
+				m_downsampledMin[ch][i] = (int32_t)stats.min;
+				m_downsampledData[ch][i] = (int32_t)stats.max;
+			}
+		}
+		downsampled.channels[ch] = m_downsampledData[ch].span();
+		if (mode == DOWNSAMPLING_MODE::AGGREGATE) {
+			downsampled.channelsMin[ch] = m_downsampledMin[ch].span();
+		}
+	}
+	return downsampled;
+}
+
 /*
  * Protected slots
  */
 
 void daq::getBlockData() {
-	std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> values = collectBlockData();
+	// shares the blocks with the locking and the scan, if they are running,
+	// otherwise the device may downsample the block before the transfer
+	const DAQ_BLOCK* acquired{ nullptr };
+	DAQ_BLOCK block;
+	if (std::any_of(m_activeConsumers.begin(), m_activeConsumers.end(), [](bool active) { return active; })) {
+		acquired = acquireBlock(DAQ_CONSUMER::LIVE_VIEW);
+		if (!acquired) {
+			return;
+		}
+		block = downsampleBlock(*acquired);
+	} else {
+		if (!m_isConnected) {
+			return;
+		}
+		block = collectDownsampledData();
+		if (std::all_of(block.channels.begin(), block.channels.end(), [](auto channel) { return channel.empty(); })) {
+			return;
+		}
+	}
 
-	//m_liveBuffer->m_freeBuffers->acquire();
-	int16_t** buffer = m_liveBuffer->getWriteBuffer();
-	for (gsl::index channel{ 0 }; channel < (gsl::index)values.size(); channel++) {
-		for (gsl::index jj{ 0 }; jj < (gsl::index)values[channel].size(); jj++) {
-			buffer[channel][jj] = values[channel][jj];
+	// the live view never waits for the acquisition and vice versa
+	int16_t** buffer = m_liveBuffer.getWriteBuffer();
+	for (gsl::index channel{ 0 }; channel < (gsl::index)block.channels.size(); channel++) {
+		// the live view only shows the first segment, the rest of the buffer and disabled channels
+		// are cleared, so that they do not keep the data of an older block
+		size_t length = std::min<size_t>(block.channels[channel].size() / block.no_of_segments, DAQ_BUFFER_SIZE);
+		std::copy_n(block.channels[channel].begin(), length, buffer[channel]);
+		std::fill(buffer[channel] + length, buffer[channel] + DAQ_BUFFER_SIZE, int16_t{ 0 });
+		// without minima the averages are the lower bound as well
+		int16_t* minima = buffer[DAQ_MAX_CHANNELS + channel];
+		if (block.channelsMin[channel].empty()) {
+			std::copy_n(buffer[channel], DAQ_BUFFER_SIZE, minima);
+		} else {
+			std::copy_n(block.channelsMin[channel].begin(), length, minima);
+			std::fill(minima + length, minima + DAQ_BUFFER_SIZE, int16_t{ 0 });
 		}
 	}
-	m_liveBuffer->m_usedBuffers->release();
+	m_liveBuffer.releaseWriteBuffer();
+	if (acquired) {
+		releaseBlock(DAQ_CONSUMER::LIVE_VIEW);
+	}
 
 	emit collectedBlockData();
 }
\ No newline at end of file
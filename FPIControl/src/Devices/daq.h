@@ -8,16 +8,31 @@
 #include <array>
 #include <chrono>
 #include <ctime>
+#include <functional>
+#include <map>
+#include <thread>
 
 #include <gsl/gsl>
-#include "..\circularBuffer.h"
+#include "..\alignedBuffer.h"
+#include "..\broadcastBuffer.h"
+#include "..\conversion.h"
+#include "..\tripleBuffer.h"
 #include "..\generalmath.h"
+#include "..\reduction.h"
+#include "..\acquisitionPlanner.h"
 
 #define DAQ_BUFFER_SIZE 	8000
 #define SINGLE_CH_SCOPE 1				// Single channel scope
 #define DUAL_SCOPE 2					// Dual channel scope
 
 #define DAQ_MAX_CHANNELS 4
+#define DAQ_BLOCK_NUMBER 8				// blocks kept for the consumers
+#define DAQ_TRIGGER_TIMEOUT 100			// [ms] a block is captured without a trigger after this time
+#define DAQ_BLOCK_TIMEOUT 1000			// [ms] a block is given up this long after its expected end and the trigger timeout
+#define DAQ_POLL_SPIN_US 200			// [us] time the readiness of a block is polled without sleeping
+#define DAQ_POLL_MIN_SLEEP_US 100		// [us] first sleep between two polls afterwards, it is doubled up to
+#define DAQ_POLL_MAX_SLEEP_US 1000		// [us]
+#define DAQ_SAMPLING_RATE_TOLERANCE 1e-3	// relative deviation of the actual sampling rate, up to which a plan is accepted
 
 typedef enum enPSCoupling {
 	PS_AC,
@@ -26,9 +41,75 @@ typedef enum enPSCoupling {
 
 typedef enum class PSTypes {
 	MODEL_PS2000 = 0,
-	MODEL_PS2000A = 1
+	MODEL_PS2000A = 1,
+	MODEL_SIMULATED = 2
 } PS_TYPES;
 
+typedef enum class AcquisitionMode {
+	BLOCK = 0,						// arm the scope for every block
+	STREAMING = 1					// stream continuously and split the data into blocks
+} ACQUISITION_MODE;
+
+typedef enum class TriggerSource {
+	NONE = 0,						// free running, the phase of the modulation at the start of a block is random
+	EXTERNAL = 1					// rising edge on the external trigger input, e.g. the reference signal
+} TRIGGER_SOURCE;
+
+// Consumers of the acquired blocks, every one of them reads the blocks at its own pace
+typedef enum class DaqConsumer {
+	LIVE_VIEW = 0,
+	LOCKING = 1,
+	SCAN = 2,
+	RECORDER = 3,					// reads every block in order, e.g. to store it
+	COUNT
+} DAQ_CONSUMER;
+
+typedef enum class DownsamplingMode {
+	NONE = 0,						// full resolution
+	AVERAGE = 1,					// mean of every downsampling_ratio samples
+	AGGREGATE = 2					// minimum and maximum of every downsampling_ratio samples
+} DOWNSAMPLING_MODE;
+
+typedef enum class TimebaseFormula {
+	POWER_OF_TWO = 0,				// maxSamplingRate / 2^timebase
+	POWER_OF_TWO_THEN_LINEAR = 1	// maxSamplingRate / 2^timebase below timebase 3, maxSamplingRate / (8 * (timebase - 2)) above
+} TIMEBASE_FORMULA;
+
+// Properties of a scope model, the devices keep constexpr tables of the models they support
+typedef struct MODEL_DESCRIPTOR {
+	int				model{ 0 };
+	int				firstRange{ 0 };
+	int				lastRange{ 0 };
+	int16_t			maxTimebase{ 0 };
+	int16_t			noOfChannels{ 0 };
+	bool			hasAdvancedTriggering{ false };
+	bool			hasSignalGenerator{ false };
+	bool			hasEts{ false };
+	bool			hasFastStreaming{ false };
+	int16_t			awgBufferSize{ 0 };
+	int16_t			bufferSize{ 0 };
+	double			maxSamplingRate{ 0 };	// [Hz]	sampling rate at timebase 0
+	TIMEBASE_FORMULA timebaseFormula{ TIMEBASE_FORMULA::POWER_OF_TWO };
+
+	// [Hz]
+	constexpr double samplingRate(int timebase) const {
+		if (timebaseFormula == TIMEBASE_FORMULA::POWER_OF_TWO || timebase < 3) {
+			return maxSamplingRate / (int64_t{ 1 } << timebase);
+		}
+		return maxSamplingRate / (8 * ((double)timebase - 2));
+	};
+} MODEL_DESCRIPTOR;
+
+template<std::size_t N>
+constexpr const MODEL_DESCRIPTOR* findModelDescriptor(const std::array<MODEL_DESCRIPTOR, N>& models, int model) {
+	for (const auto& descriptor : models) {
+		if (descriptor.model == model) {
+			return &descriptor;
+		}
+	}
+	return nullptr;
+}
+
 typedef struct CHANNEL_SETTINGS {
 	int coupling = PS_DC;
 	int16_t range{ 0 };
@@ -65,27 +146,80 @@ typedef struct ACQUISITION_PARAMETERS {
 	int16_t 	time_units{ 0 };
 	int16_t 	oversample{ 0 };
 	uint32_t 	no_of_samples{ 1000 };
+	uint32_t 	no_of_segments{ 1 };		// number of consecutive blocks captured at once
 	int32_t 	max_samples{ 0 };
 	int32_t 	time_indisposed_ms{ 0 };
 	int16_t		timebase{ 0 };
 	int			timebaseIndex{ 0 };
+	ACQUISITION_MODE mode{ ACQUISITION_MODE::BLOCK };
+	TRIGGER_SOURCE trigger{ TRIGGER_SOURCE::NONE };
+	uint32_t	downsampling_ratio{ 1 };	// samples combined into one point for the live view
+	DOWNSAMPLING_MODE downsampling_mode{ DOWNSAMPLING_MODE::NONE };
 	DEFAULT_CHANNEL_SETTINGS channelSettings[2] = {
 		{PS_AC, 2, true},
 		{PS_AC, 5, true}
 	};
 } ACQUISITION_PARAMETERS;
 
+// Settings, which differ between the requested and the applied acquisition parameters
+typedef struct CONFIGURATION_CHANGES {
+	bool unit{ true };				// settings, which only have to be applied once after connecting
+	bool channels{ true };			// enabled, coupling and range of the channels
+	bool segments{ true };			// number of segments and their size
+	bool timebase{ true };			// timebase for the number of samples
+	bool mode{ true };				// block or streaming mode
+	bool trigger{ true };			// trigger source
+	bool any() const { return unit || channels || segments || timebase || mode || trigger; };
+} CONFIGURATION_CHANGES;
+
+// Result of looking up a timebase on the device
+typedef struct TIMEBASE_INFO {
+	int16_t		timebase{ 0 };		// first timebase, which is valid for the number of samples
+	int32_t		time_interval{ 0 };
+	int16_t		time_units{ 0 };
+	int32_t		max_samples{ 0 };
+} TIMEBASE_INFO;
+
+// Properties of an acquired block, so that the consumers can check its age, completeness and validity
+typedef struct DAQ_BLOCK_INFO {
+	uint64_t	sequence{ 0 };						// consecutive number of the acquired blocks, gaps are blocks the consumer did not get
+	std::chrono::steady_clock::time_point armed;		// start of the capture, in streaming mode the start of streaming
+	std::chrono::steady_clock::time_point ready;		// the capture was complete
+	std::chrono::steady_clock::time_point transferred;	// the samples were transferred from the device
+	int16_t		overflow{ 0 };						// bit field of the channels, which exceeded their range
+	double		samplingRate{ 0 };					// [Hz]
+	uint32_t	no_of_samples{ 0 };					// samples per segment
+} DAQ_BLOCK_INFO;
+
+// View onto the data of one acquired block. The samples are owned by the daq and stay
+// valid until the consumer releases the block or gets the next one.
+typedef struct DAQ_BLOCK {
+	std::array<gsl::span<const int32_t>, DAQ_MAX_CHANNELS> channels;	// [mV] empty if the channel is disabled
+	std::array<gsl::span<const int32_t>, DAQ_MAX_CHANNELS> channelsMin;	// [mV] minima if aggregated, then channels holds the maxima
+	uint32_t no_of_segments{ 1 };		// number of segments of no_of_samples each channel consists of
+	DAQ_BLOCK_INFO info;
+} DAQ_BLOCK;
+
+// Block in the ring shared by all consumers, the view points into the storage of the same slot.
+// All channels are stored in one slab indexed as [channel][sample], every channel starts on a cache line.
+typedef struct DAQ_BLOCK_SLOT {
+	DAQ_BLOCK block;
+	AlignedBuffer<int32_t> storage;		// slab reused for every block, mapped in pages for large blocks
+	std::array<gsl::span<int32_t>, DAQ_MAX_CHANNELS> channels;	// channels within the slab, empty if disabled
+} DAQ_BLOCK_SLOT;
+
 class daq : public QObject {
 	Q_OBJECT
 
 	public:
 		explicit daq(QObject *parent);
-		explicit daq(QObject *parent, std::vector<int32_t> ranges, std::vector<int> timebases, double maxSamplingRate);
+		explicit daq(QObject *parent, std::vector<int32_t> ranges, std::vector<int> timebases, const MODEL_DESCRIPTOR& model);
 
 		virtual void setAcquisitionParameters() = 0;
-		virtual std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> collectBlockData() = 0;
+		virtual DAQ_BLOCK collectBlockData() = 0;
+		virtual DAQ_BLOCK collectDownsampledData();	// block for the live view, if it is the only consumer
 		virtual void setOutputVoltage(double voltage) = 0;
-		virtual double getCurrentSamplingRate() = 0;
+		virtual double getCurrentSamplingRate();
 
 		std::vector<double> getSamplingRates();
 
@@ -95,12 +229,33 @@ class daq : public QObject {
 		void setCoupling(int coupling, int ch);
 		void setRange(int index, int ch);
 		void setNumberSamples(int32_t no_of_samples);
+		void setAcquisitionMode(ACQUISITION_MODE mode);
+		void setTrigger(TRIGGER_SOURCE trigger);
+		void setChannelEnabled(int ch, bool enabled);
+		void setNumberSegments(uint32_t no_of_segments);
+		void setDownsampling(uint32_t ratio, DOWNSAMPLING_MODE mode);
+		void setPipelining(bool pipelined);
+		void discardArmedBlock();	// after the output voltage changed
+		void setConsumerActive(DAQ_CONSUMER consumer, bool active);
+		// choose and apply the sampling rate and number of samples for an integer number of modulation periods per block
+		ACQUISITION_PLAN planAcquisition(double frequency, double tolerance);
+		bool applyAcquisitionPlan(const ACQUISITION_PLAN& plan);
+
+		// Every block is acquired once and shared by all consumers. These functions return nullptr
+		// if the consumer has seen all blocks, the block is held until it is released or the
+		// consumer gets the next one.
+		const DAQ_BLOCK* acquireBlock(DAQ_CONSUMER consumer);	// newest unseen block, a new one is acquired if necessary
+		const DAQ_BLOCK* readBlock(DAQ_CONSUMER consumer, READ_POLICY policy = READ_POLICY::NEXT);	// never acquires, can be called from any thread
+		void releaseBlock(DAQ_CONSUMER consumer);
+		void skipBlocks(DAQ_CONSUMER consumer);		// only blocks acquired from now on are returned
+		uint64_t getSkippedBlocks(DAQ_CONSUMER consumer);
 
-		CircularBuffer<int16_t> *m_liveBuffer = new CircularBuffer<int16_t>(4, DAQ_MAX_CHANNELS, 8000);
+		// the live view only shows the newest block, the averages or maxima of the channels are followed by their minima
+		TripleBuffer<int16_t> m_liveBuffer{ 2 * DAQ_MAX_CHANNELS, DAQ_BUFFER_SIZE };
 
 		std::vector<int32_t> m_input_ranges;
 
-		std::vector<std::string> PS_NAMES = { "PS2000", "PS2000A" };
+		std::vector<std::string> PS_NAMES = { "PS2000", "PS2000A", "Simulated" };
 
 	public slots:
 		virtual void connect() = 0;
@@ -116,6 +271,31 @@ class daq : public QObject {
 		int32_t adc_to_mv(int32_t raw, int32_t ch);
 		int16_t mv_to_adc(int16_t mv, int16_t ch);
 
+		bool waitForBlock(std::function<int()> isReady);
+		DAQ_BLOCK_INFO prepareBlockInfo();
+		DAQ_BLOCK prepareBlock();
+		DAQ_BLOCK downsampleBlock(const DAQ_BLOCK& block);
+		void convertChannel(gsl::index ch, const int16_t* raw);
+		void convertChannel(gsl::index ch, const int16_t* raw, gsl::span<int32_t> target);
+
+		// Configuration transactions: only the settings, which changed since
+		// the last commitConfiguration(), have to be sent to the device.
+		CONFIGURATION_CHANGES beginConfiguration();
+		void commitConfiguration();
+		void invalidateConfiguration();
+		TIMEBASE_INFO getTimebase(int16_t timebase, uint32_t no_of_samples);
+		virtual TIMEBASE_INFO findTimebase(int16_t timebase, uint32_t no_of_samples) { return { timebase }; };
+
+		// Pipelining: the next block is armed as soon as the previous one was transferred,
+		// so that the capture overlaps with the conversion and processing on the host.
+		virtual bool armBlock() { return false; };	// start a capture without waiting, false if not supported
+		virtual void abortBlock() {};				// stop a capture started by armBlock()
+		void startBlock();
+		void armNextBlock();
+
+		bool isConfigurableChannel(int ch);
+		void applyChannelSettings();
+
 		UNIT_MODEL m_unitOpened;
 		bool m_isConnected{ false };
 		bool m_acquisitionRunning{ false };
@@ -123,10 +303,28 @@ class daq : public QObject {
 		ACQUISITION_PARAMETERS m_acquisitionParameters;
 		int16_t m_overflow{ 0 };
 		bool m_scale_to_mv{ true };
+		bool m_pipelined{ false };
+		bool m_blockArmed{ false };		// a capture is running, which was not read yet
+		std::chrono::steady_clock::time_point m_blockStarted;
+		std::chrono::steady_clock::time_point m_blockCompleted;
+		uint64_t m_acquiredBlocks{ 0 };		// numbers the blocks, including those only downsampled for the live view
+
+		ACQUISITION_PARAMETERS m_appliedParameters;		// parameters the device was configured with
+		bool m_configurationApplied{ false };
+		std::map<std::pair<int16_t, uint32_t>, TIMEBASE_INFO> m_timebaseCache;	// keyed by timebase and number of samples
+
+		BroadcastBuffer<DAQ_BLOCK_SLOT> m_blocks{ DAQ_BLOCK_NUMBER, (int)DAQ_CONSUMER::COUNT };	// acquired blocks shared by all consumers
+		std::array<AlignedBuffer<int32_t>, DAQ_MAX_CHANNELS> m_downsampledData;	// averages or maxima of a downsampled block
+		std::array<AlignedBuffer<int32_t>, DAQ_MAX_CHANNELS> m_downsampledMin;	// minima of an aggregated block
+		std::array<bool, (int)DAQ_CONSUMER::COUNT> m_activeConsumers{};		// the live view is not tracked, it always runs with the acquisition
+
+		void applyModel(const MODEL_DESCRIPTOR& model);
+		void calculateSamplingRates();
 
-		double m_maxSamplingRate{ 0 };
+		MODEL_DESCRIPTOR m_model;		// model of the connected device or the default model
 		std::vector<int> m_availableTimebases;
 		std::vector<double> m_availableSamplingRates;
+		double m_configuredDuration{ 0 };	// [s] block duration set by the user, the target of the acquisition plans
 
 	protected slots:
 		void getBlockData();
@@ -1,23 +1,400 @@
 #ifndef PDH_H
 #define PDH_H
 
+#include <algorithm>
 #include <cmath>
 #include <complex>
+#include <limits>
 #include "generalmath.h"
+#include "reduction.h"
+#include "referenceTable.h"
+
+#define PDH_DEGREE	(3.14159265358979323846 / 180)	// [rad]	one degree
+
+// Result of demodulating one block
+typedef struct PDH_RESULT {
+	double inPhase{ NAN };		// mean of the product of the normalised transmission and the reference
+	double quadrature{ NAN };	// same for the reference shifted by a quarter period
+	double min{ NAN };			// minimum of the transmission signal
+	double max{ NAN };			// maximum of the transmission signal
+	double sum{ 0 };			// sum of the transmission signal
+	std::size_t count{ 0 };		// number of demodulated samples
+	double amplitude() const { return max - min; };
+	double magnitude() const { return std::hypot(inPhase, quadrature); };
+	// [degree] phase, at which the error signal is largest
+	double phase() const { return std::atan2(quadrature, inPhase) / PDH_DEGREE; };
+	// error signal for the reference shifted by phase [degree]
+	double error(double phase) const {
+		return inPhase * std::cos(phase * PDH_DEGREE) + quadrature * std::sin(phase * PDH_DEGREE);
+	};
+} PDH_RESULT;
 
 class PDH {
 	public:
-		template <typename T = double>
-		static T getError(std::vector<T> data, std::vector<T> reference) {
-			
-			std::vector<T> tmp(data.size());
-			
-			std::transform(data.begin(), data.end(),
-				reference.begin(), tmp.begin(),
-				std::multiplies<T>()
-			);
-			
-			return generalmath::mean(tmp);
+		// Demodulate the transmission signal with the reference shifted by inPhaseStep and quadratureStep samples
+		// to the left, wrapping around at the end. This is only valid for a single segment, which covers an integer
+		// number of modulation periods: for segmented blocks the shifted reference slips in phase at every boundary
+		// between the segments, which are demodulated with a ReferenceTable instead.
+		// The channel buffers are read once and nothing is allocated:
+		// the normalisation to the minimum and the amplitude of the transmission is linear,
+		// so it is applied to the sums instead of every sample:
+		// mean((t - min) / amplitude * r) = (sum(t * r) - min * sum(r)) / (amplitude * n)
+		// If quadratureStep is a quarter period of a sinusoidal reference, the error signal for any phase
+		// follows from the in-phase and quadrature components.
+		static PDH_RESULT demodulate(gsl::span<const int32_t> transmission, gsl::span<const int32_t> reference,
+			gsl::index inPhaseStep, gsl::index quadratureStep) {
+			PDH_RESULT result;
+			const gsl::index length = std::min(transmission.size(), reference.size());
+			if (length == 0) {
+				return result;
+			}
+			const gsl::index inPhaseShift = generalmath::indexWrapped((int)inPhaseStep, (int)length);
+			const gsl::index quadratureShift = generalmath::indexWrapped((int)quadratureStep, (int)length);
+
+			// both shifted references are contiguous between the samples, at which one of them wraps around
+			gsl::index bounds[4] = { 0, length - inPhaseShift, length - quadratureShift, length };
+			std::sort(&bounds[1], &bounds[3]);
+			SUMS sums;
+			for (gsl::index i{ 0 }; i < 3; i++) {
+				gsl::index start = bounds[i];
+				gsl::index size = bounds[i + 1] - start;
+				if (size > 0) {
+					accumulate(transmission.subspan(start, size),
+						reference.subspan((start + inPhaseShift) % length, size),
+						reference.subspan((start + quadratureShift) % length, size), sums);
+				}
+			}
+
+			result.min = sums.min;
+			result.max = sums.max;
+			result.sum = sums.transmission;
+			result.count = length;
+			double amplitude = result.amplitude();
+			// a constant transmission signal is not normalised,
+			// the sum of the reference is the same for both shifts
+			if (amplitude != 0) {
+				result.inPhase = (sums.inPhase - sums.min * sums.reference) / (amplitude * length);
+				result.quadrature = (sums.quadrature - sums.min * sums.reference) / (amplitude * length);
+			} else {
+				result.inPhase = sums.inPhase / length;
+				result.quadrature = sums.quadrature / length;
+			}
+			return result;
+		};
+
+		// Demodulate the transmission and the reference signal with the synthesised reference of the table.
+		// Every segment of the length of the table is demodulated on its own, as the acquisition is not
+		// triggered and the phase of the modulation changes from segment to segment. The product of the
+		// phasors of both signals does not depend on the phase of the table:
+		// for t = a cos(wt + alpha) and r = b cos(wt + beta) the in-phase component is a b / 2 cos(alpha - beta)
+		// like for the measured reference, but the phase of the error signal is not limited to whole samples.
+		static PDH_RESULT demodulate(gsl::span<const int32_t> transmission, gsl::span<const int32_t> reference,
+			const ReferenceTable& table) {
+			PDH_RESULT result;
+			const gsl::index length = std::min(transmission.size(), reference.size());
+			const gsl::index segmentLength = table.size();
+			if (length == 0 || segmentLength == 0) {
+				return result;
+			}
+
+			PHASOR_SUMS sums;
+			// sum of the products of the phasors of the transmission and the conjugated reference,
+			// and of the phasor of a constant signal and the conjugated reference for the normalisation
+			std::complex<double> product{ 0 };
+			std::complex<double> offset{ 0 };
+			for (gsl::index start{ 0 }; start < length; start += segmentLength) {
+				gsl::index size = std::min(segmentLength, length - start);
+				sums.clearPhasors();
+				accumulate<true>(transmission.subspan(start, size), reference.subspan(start, size),
+					table.cosine().first(size), table.sine().first(size), sums);
+				std::complex<double> phasorTransmission = std::complex<double>(sums.transmissionCosine, -sums.transmissionSine) / (double)size;
+				std::complex<double> phasorReference = std::complex<double>(sums.referenceCosine, -sums.referenceSine) / (double)size;
+				// weight the segments by their length like the mean over the whole block
+				double weight = (double)size / length;
+				product += weight * phasorTransmission * std::conj(phasorReference);
+				offset += weight * table.mean(size) * std::conj(phasorReference);
+			}
+
+			result.min = sums.min;
+			result.max = sums.max;
+			result.sum = sums.transmission;
+			result.count = length;
+			double amplitude = result.amplitude();
+			// a constant transmission signal is not normalised
+			std::complex<double> error = (amplitude != 0) ? 2.0 * (product - sums.min * offset) / amplitude : 2.0 * product;
+			result.inPhase = error.real();
+			result.quadrature = error.imag();
+			return result;
+		};
+
+		// Demodulate only the transmission signal, if the reference signal is not acquired. The acquisition has to be
+		// triggered on the modulation, so that the phase of the modulation is the same in every segment. The table
+		// then has the phase of the measured reference at the trigger, which was calibrated once, and the result
+		// equals demodulating a measured reference of the given amplitude.
+		static PDH_RESULT demodulate(gsl::span<const int32_t> transmission, const ReferenceTable& table, double referenceAmplitude) {
+			PDH_RESULT result;
+			const gsl::index length = transmission.size();
+			const gsl::index segmentLength = table.size();
+			if (length == 0 || segmentLength == 0) {
+				return result;
+			}
+
+			PHASOR_SUMS sums;
+			// phasors of the transmission and of a constant signal for the normalisation
+			std::complex<double> phasor{ 0 };
+			std::complex<double> offset{ 0 };
+			for (gsl::index start{ 0 }; start < length; start += segmentLength) {
+				gsl::index size = std::min(segmentLength, length - start);
+				sums.clearPhasors();
+				accumulate<false>(transmission.subspan(start, size), gsl::span<const int32_t>(),
+					table.cosine().first(size), table.sine().first(size), sums);
+				double weight = (double)size / length;
+				phasor += weight * std::complex<double>(sums.transmissionCosine, -sums.transmissionSine) / (double)size;
+				offset += weight * table.mean(size);
+			}
+
+			result.min = sums.min;
+			result.max = sums.max;
+			result.sum = sums.transmission;
+			result.count = length;
+			double amplitude = result.amplitude();
+			// the phasor of the synthesised reference is real with half its amplitude
+			std::complex<double> error = referenceAmplitude * ((amplitude != 0) ? (phasor - sums.min * offset) / amplitude : phasor);
+			result.inPhase = error.real();
+			result.quadrature = error.imag();
+			return result;
+		};
+
+	private:
+		typedef struct SUMS {
+			double min{ std::numeric_limits<double>::infinity() };
+			double max{ -std::numeric_limits<double>::infinity() };
+			double transmission{ 0 };
+			double reference{ 0 };
+			double inPhase{ 0 };
+			double quadrature{ 0 };
+		} SUMS;
+
+		// add segments of the same length to the sums
+		static void accumulate(gsl::span<const int32_t> transmission, gsl::span<const int32_t> inPhase,
+			gsl::span<const int32_t> quadrature, SUMS& sums) {
+			const gsl::index length = transmission.size();
+			gsl::index i{ 0 };
+#if defined(__AVX2__)
+			__m256d min = _mm256_set1_pd(sums.min);
+			__m256d max = _mm256_set1_pd(sums.max);
+			__m256d sumTransmission = _mm256_setzero_pd();
+			__m256d sumReference = _mm256_setzero_pd();
+			__m256d sumInPhase = _mm256_setzero_pd();
+			__m256d sumQuadrature = _mm256_setzero_pd();
+			auto add = [&](__m256d t, __m256d r, __m256d q) {
+				min = _mm256_min_pd(min, t);
+				max = _mm256_max_pd(max, t);
+				sumTransmission = _mm256_add_pd(sumTransmission, t);
+				sumReference = _mm256_add_pd(sumReference, r);
+				sumInPhase = _mm256_add_pd(sumInPhase, _mm256_mul_pd(t, r));
+				sumQuadrature = _mm256_add_pd(sumQuadrature, _mm256_mul_pd(t, q));
+			};
+			for (; i + 8 <= length; i += 8) {
+				__m256d tLow, tHigh, rLow, rHigh, qLow, qHigh;
+				reduction::load(&transmission[i], tLow, tHigh);
+				reduction::load(&inPhase[i], rLow, rHigh);
+				reduction::load(&quadrature[i], qLow, qHigh);
+				add(tLow, rLow, qLow);
+				add(tHigh, rHigh, qHigh);
+			}
+			alignas(32) double lanes[6][4];
+			_mm256_store_pd(lanes[0], min);
+			_mm256_store_pd(lanes[1], max);
+			_mm256_store_pd(lanes[2], sumTransmission);
+			_mm256_store_pd(lanes[3], sumReference);
+			_mm256_store_pd(lanes[4], sumInPhase);
+			_mm256_store_pd(lanes[5], sumQuadrature);
+			combine(sums, lanes, 4);
+#elif defined(REDUCTION_SSE2)
+			__m128d min = _mm_set1_pd(sums.min);
+			__m128d max = _mm_set1_pd(sums.max);
+			__m128d sumTransmission = _mm_setzero_pd();
+			__m128d sumReference = _mm_setzero_pd();
+			__m128d sumInPhase = _mm_setzero_pd();
+			__m128d sumQuadrature = _mm_setzero_pd();
+			auto add = [&](__m128d t, __m128d r, __m128d q) {
+				min = _mm_min_pd(min, t);
+				max = _mm_max_pd(max, t);
+				sumTransmission = _mm_add_pd(sumTransmission, t);
+				sumReference = _mm_add_pd(sumReference, r);
+				sumInPhase = _mm_add_pd(sumInPhase, _mm_mul_pd(t, r));
+				sumQuadrature = _mm_add_pd(sumQuadrature, _mm_mul_pd(t, q));
+			};
+			for (; i + 4 <= length; i += 4) {
+				__m128d tLow, tHigh, rLow, rHigh, qLow, qHigh;
+				reduction::load(&transmission[i], tLow, tHigh);
+				reduction::load(&inPhase[i], rLow, rHigh);
+				reduction::load(&quadrature[i], qLow, qHigh);
+				add(tLow, rLow, qLow);
+				add(tHigh, rHigh, qHigh);
+			}
+			alignas(16) double lanes[6][4];
+			_mm_store_pd(lanes[0], min);
+			_mm_store_pd(lanes[1], max);
+			_mm_store_pd(lanes[2], sumTransmission);
+			_mm_store_pd(lanes[3], sumReference);
+			_mm_store_pd(lanes[4], sumInPhase);
+			_mm_store_pd(lanes[5], sumQuadrature);
+			combine(sums, lanes, 2);
+#endif
+			for (; i < length; i++) {
+				double t = transmission[i];
+				double r = inPhase[i];
+				sums.min = std::min(sums.min, t);
+				sums.max = std::max(sums.max, t);
+				sums.transmission += t;
+				sums.reference += r;
+				sums.inPhase += t * r;
+				sums.quadrature += t * quadrature[i];
+			}
+		};
+
+		typedef struct PHASOR_SUMS {
+			double min{ std::numeric_limits<double>::infinity() };
+			double max{ -std::numeric_limits<double>::infinity() };
+			double transmission{ 0 };
+			double transmissionCosine{ 0 };
+			double transmissionSine{ 0 };
+			double referenceCosine{ 0 };
+			double referenceSine{ 0 };
+			void clearPhasors() {
+				transmissionCosine = 0;
+				transmissionSine = 0;
+				referenceCosine = 0;
+				referenceSine = 0;
+			};
+		} PHASOR_SUMS;
+
+		// add a segment multiplied with the cosine and sine table to the sums,
+		// the reference is only read if it was acquired
+		template<bool REFERENCE>
+		static void accumulate(gsl::span<const int32_t> transmission, gsl::span<const int32_t> reference,
+			gsl::span<const float> cosine, gsl::span<const float> sine, PHASOR_SUMS& sums) {
+			const gsl::index length = transmission.size();
+			gsl::index i{ 0 };
+#if defined(__AVX2__)
+			__m256d min = _mm256_set1_pd(sums.min);
+			__m256d max = _mm256_set1_pd(sums.max);
+			__m256d sumTransmission = _mm256_setzero_pd();
+			__m256d transmissionCosine = _mm256_setzero_pd();
+			__m256d transmissionSine = _mm256_setzero_pd();
+			__m256d referenceCosine = _mm256_setzero_pd();
+			__m256d referenceSine = _mm256_setzero_pd();
+			auto add = [&](__m256d t, __m256d r, __m256d c, __m256d s) {
+				min = _mm256_min_pd(min, t);
+				max = _mm256_max_pd(max, t);
+				sumTransmission = _mm256_add_pd(sumTransmission, t);
+				transmissionCosine = _mm256_add_pd(transmissionCosine, _mm256_mul_pd(t, c));
+				transmissionSine = _mm256_add_pd(transmissionSine, _mm256_mul_pd(t, s));
+				if (REFERENCE) {
+					referenceCosine = _mm256_add_pd(referenceCosine, _mm256_mul_pd(r, c));
+					referenceSine = _mm256_add_pd(referenceSine, _mm256_mul_pd(r, s));
+				}
+			};
+			for (; i + 8 <= length; i += 8) {
+				__m256d tLow, tHigh, cLow, cHigh, sLow, sHigh;
+				__m256d rLow = _mm256_setzero_pd(), rHigh = _mm256_setzero_pd();
+				reduction::load(&transmission[i], tLow, tHigh);
+				if (REFERENCE) {
+					reduction::load(&reference[i], rLow, rHigh);
+				}
+				reduction::load(&cosine[i], cLow, cHigh);
+				reduction::load(&sine[i], sLow, sHigh);
+				add(tLow, rLow, cLow, sLow);
+				add(tHigh, rHigh, cHigh, sHigh);
+			}
+			alignas(32) double lanes[7][4];
+			_mm256_store_pd(lanes[0], min);
+			_mm256_store_pd(lanes[1], max);
+			_mm256_store_pd(lanes[2], sumTransmission);
+			_mm256_store_pd(lanes[3], transmissionCosine);
+			_mm256_store_pd(lanes[4], transmissionSine);
+			_mm256_store_pd(lanes[5], referenceCosine);
+			_mm256_store_pd(lanes[6], referenceSine);
+			combine(sums, lanes, 4);
+#elif defined(REDUCTION_SSE2)
+			__m128d min = _mm_set1_pd(sums.min);
+			__m128d max = _mm_set1_pd(sums.max);
+			__m128d sumTransmission = _mm_setzero_pd();
+			__m128d transmissionCosine = _mm_setzero_pd();
+			__m128d transmissionSine = _mm_setzero_pd();
+			__m128d referenceCosine = _mm_setzero_pd();
+			__m128d referenceSine = _mm_setzero_pd();
+			auto add = [&](__m128d t, __m128d r, __m128d c, __m128d s) {
+				min = _mm_min_pd(min, t);
+				max = _mm_max_pd(max, t);
+				sumTransmission = _mm_add_pd(sumTransmission, t);
+				transmissionCosine = _mm_add_pd(transmissionCosine, _mm_mul_pd(t, c));
+				transmissionSine = _mm_add_pd(transmissionSine, _mm_mul_pd(t, s));
+				if (REFERENCE) {
+					referenceCosine = _mm_add_pd(referenceCosine, _mm_mul_pd(r, c));
+					referenceSine = _mm_add_pd(referenceSine, _mm_mul_pd(r, s));
+				}
+			};
+			for (; i + 4 <= length; i += 4) {
+				__m128d tLow, tHigh, cLow, cHigh, sLow, sHigh;
+				__m128d rLow = _mm_setzero_pd(), rHigh = _mm_setzero_pd();
+				reduction::load(&transmission[i], tLow, tHigh);
+				if (REFERENCE) {
+					reduction::load(&reference[i], rLow, rHigh);
+				}
+				reduction::load(&cosine[i], cLow, cHigh);
+				reduction::load(&sine[i], sLow, sHigh);
+				add(tLow, rLow, cLow, sLow);
+				add(tHigh, rHigh, cHigh, sHigh);
+			}
+			alignas(16) double lanes[7][4];
+			_mm_store_pd(lanes[0], min);
+			_mm_store_pd(lanes[1], max);
+			_mm_store_pd(lanes[2], sumTransmission);
+			_mm_store_pd(lanes[3], transmissionCosine);
+			_mm_store_pd(lanes[4], transmissionSine);
+			_mm_store_pd(lanes[5], referenceCosine);
+			_mm_store_pd(lanes[6], referenceSine);
+			combine(sums, lanes, 2);
+#endif
+			for (; i < length; i++) {
+				double t = transmission[i];
+				sums.min = std::min(sums.min, t);
+				sums.max = std::max(sums.max, t);
+				sums.transmission += t;
+				sums.transmissionCosine += t * cosine[i];
+				sums.transmissionSine += t * sine[i];
+				if (REFERENCE) {
+					double r = reference[i];
+					sums.referenceCosine += r * cosine[i];
+					sums.referenceSine += r * sine[i];
+				}
+			}
+		};
+
+		static void combine(PHASOR_SUMS& sums, const double lanes[7][4], int width) {
+			for (gsl::index lane{ 0 }; lane < width; lane++) {
+				sums.min = std::min(sums.min, lanes[0][lane]);
+				sums.max = std::max(sums.max, lanes[1][lane]);
+				sums.transmission += lanes[2][lane];
+				sums.transmissionCosine += lanes[3][lane];
+				sums.transmissionSine += lanes[4][lane];
+				sums.referenceCosine += lanes[5][lane];
+				sums.referenceSine += lanes[6][lane];
+			}
+		};
+
+		static void combine(SUMS& sums, const double lanes[6][4], int width) {
+			for (gsl::index lane{ 0 }; lane < width; lane++) {
+				sums.min = std::min(sums.min, lanes[0][lane]);
+				sums.max = std::max(sums.max, lanes[1][lane]);
+				sums.transmission += lanes[2][lane];
+				sums.reference += lanes[3][lane];
+				sums.inPhase += lanes[4][lane];
+				sums.quadrature += lanes[5][lane];
+			}
 		};
 };
 
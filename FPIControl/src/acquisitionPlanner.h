@@ -0,0 +1,83 @@
+#ifndef ACQUISITIONPLANNER_H
+#define ACQUISITIONPLANNER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <gsl/gsl>
+
+#define ACQUISITIONPLANNER_MIN_SAMPLES_PER_PERIOD	4		//			the modulation has to be resolved for the demodulation
+#define ACQUISITIONPLANNER_PERIOD_RANGE				0.25	// [1]		relative deviation from the target number of periods
+
+// Block size and sampling rate for a given modulation frequency
+typedef struct ACQUISITION_PLAN {
+	int timebaseIndex{ -1 };		//			index of the sampling rate, -1 if no sampling rate resolves the modulation
+	double samplingRate{ 0 };		// [Hz]
+	uint32_t no_of_samples{ 0 };
+	double periods{ 0 };			//			number of modulation periods per block
+	double leakage{ 0 };			// [periods]	deviation from an integer number of periods
+	bool integer{ false };			//			is the leakage within the tolerance?
+} ACQUISITION_PLAN;
+
+// Chooses the sampling rate and number of samples, so that a block holds an integer number of
+// modulation periods. The mean over a partial period leaks into the demodulated error signal.
+class acquisitionPlanner {
+public:
+	// Plans with an integer number of periods are preferred, then plans within the range around the target
+	// duration of a block, then higher sampling rates and then plans closer to the target duration.
+	// Without an integer plan the one with the least leakage is returned.
+	static ACQUISITION_PLAN plan(double frequency, gsl::span<const double> samplingRates, double targetDuration,
+		uint32_t maxSamples, double tolerance) {
+		ACQUISITION_PLAN best;
+		if (!(frequency > 0)) {
+			return best;
+		}
+		for (gsl::index index{ 0 }; index < (gsl::index)samplingRates.size(); index++) {
+			double samplesPerPeriod = samplingRates[index] / frequency;
+			int64_t maxPeriods = (int64_t)floor(maxSamples / samplesPerPeriod);
+			if (samplesPerPeriod < ACQUISITIONPLANNER_MIN_SAMPLES_PER_PERIOD || maxPeriods < 1) {
+				continue;
+			}
+			int64_t targetPeriods = std::clamp<int64_t>((int64_t)round(targetDuration * frequency), 1, maxPeriods);
+			int64_t minPeriods = std::max<int64_t>(1, (int64_t)ceil((1 - ACQUISITIONPLANNER_PERIOD_RANGE) * targetPeriods));
+			int64_t lastPeriods = std::min<int64_t>(maxPeriods, (int64_t)floor((1 + ACQUISITIONPLANNER_PERIOD_RANGE) * targetPeriods));
+			for (int64_t periods{ minPeriods }; periods <= lastPeriods; periods++) {
+				ACQUISITION_PLAN candidate;
+				candidate.timebaseIndex = (int)index;
+				candidate.samplingRate = samplingRates[index];
+				candidate.no_of_samples = (uint32_t)std::clamp<int64_t>((int64_t)round(periods * samplesPerPeriod), 1, maxSamples);
+				candidate.periods = candidate.no_of_samples / samplesPerPeriod;
+				candidate.leakage = std::abs(candidate.periods - round(candidate.periods));
+				candidate.integer = candidate.leakage <= tolerance;
+				if (isBetter(candidate, best, targetDuration * frequency)) {
+					best = candidate;
+				}
+			}
+		}
+		return best;
+	}
+
+private:
+	static bool isBetter(const ACQUISITION_PLAN& candidate, const ACQUISITION_PLAN& best, double targetPeriods) {
+		if (best.timebaseIndex < 0) {
+			return true;
+		}
+		if (candidate.integer != best.integer) {
+			return candidate.integer;
+		}
+		if (!candidate.integer) {
+			return candidate.leakage < best.leakage;
+		}
+		bool candidateInRange = std::abs(candidate.periods - targetPeriods) <= ACQUISITIONPLANNER_PERIOD_RANGE * targetPeriods;
+		bool bestInRange = std::abs(best.periods - targetPeriods) <= ACQUISITIONPLANNER_PERIOD_RANGE * targetPeriods;
+		if (candidateInRange != bestInRange) {
+			return candidateInRange;
+		}
+		if (candidate.samplingRate != best.samplingRate) {
+			return candidate.samplingRate > best.samplingRate;
+		}
+		return std::abs(candidate.periods - targetPeriods) < std::abs(best.periods - targetPeriods);
+	}
+};
+
+#endif // ACQUISITIONPLANNER_H
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef ALIGNEDBUFFER_H
+#define ALIGNEDBUFFER_H
+
+#include <cstddef>
+#include <new>
+#include <gsl/gsl>
+#include "pageMemory.h"
+
+#define ALIGNEDBUFFER_PAGE_THRESHOLD	(2 * 1024 * 1024)	// [byte]	larger buffers are mapped from the operating system
+
+// Storage for arithmetic types aligned to a cache line. The memory is only reallocated
+// if the buffer has to grow (without preserving the content), so resizing it every cycle is cheap.
+// Large buffers are mapped in pages, which are aligned as well.
+template<class T, std::size_t Alignment = 64> class AlignedBuffer {
+
+public:
+	AlignedBuffer() noexcept = default;
+	explicit AlignedBuffer(std::size_t size);
+	~AlignedBuffer();
+
+	AlignedBuffer(const AlignedBuffer&) = delete;
+	AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+	void resize(std::size_t size);
+
+	T* data() noexcept { return m_data; };
+	const T* data() const noexcept { return m_data; };
+	std::size_t size() const noexcept { return m_size; };
+	gsl::span<T> span() noexcept { return { m_data, m_size }; };
+	gsl::span<const T> span() const noexcept { return { m_data, m_size }; };
+
+	T& operator[](gsl::index i) noexcept { return m_data[i]; };
+	const T& operator[](gsl::index i) const noexcept { return m_data[i]; };
+
+private:
+	void release() noexcept;
+
+	T* m_data{ nullptr };
+	std::size_t m_size{ 0 };
+	std::size_t m_capacity{ 0 };
+	bool m_pageBacked{ false };
+};
+
+template<class T, std::size_t Alignment>
+inline AlignedBuffer<T, Alignment>::AlignedBuffer(std::size_t size) {
+	resize(size);
+}
+
+template<class T, std::size_t Alignment>
+inline AlignedBuffer<T, Alignment>::~AlignedBuffer() {
+	release();
+}
+
+template<class T, std::size_t Alignment>
+inline void AlignedBuffer<T, Alignment>::resize(std::size_t size) {
+	if (size > m_capacity) {
+		release();
+		m_pageBacked = size * sizeof(T) >= ALIGNEDBUFFER_PAGE_THRESHOLD;
+		if (m_pageBacked) {
+			m_data = static_cast<T*>(pageMemory::allocate(size * sizeof(T)));
+		} else {
+			m_data = static_cast<T*>(::operator new[](size * sizeof(T), std::align_val_t(Alignment)));
+		}
+		m_capacity = size;
+	}
+	m_size = size;
+}
+
+template<class T, std::size_t Alignment>
+inline void AlignedBuffer<T, Alignment>::release() noexcept {
+	if (m_pageBacked) {
+		pageMemory::release(m_data, m_capacity * sizeof(T));
+	} else {
+		::operator delete[](m_data, std::align_val_t(Alignment));
+	}
+	m_data = nullptr;
+	m_capacity = 0;
+	m_size = 0;
+}
+
+#endif //ALIGNEDBUFFER_H
\ No newline at end of file
@@ -0,0 +1,172 @@
+#ifndef BROADCASTBUFFER_H
+#define BROADCASTBUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <gsl/gsl>
+
+typedef enum class ReadPolicy {
+	NEXT = 0,				// the oldest unread buffer, e.g. to record every buffer
+	NEWEST = 1				// the newest buffer, older unread ones are skipped
+} READ_POLICY;
+
+// Ring of buffers written by a single producer and read by a fixed number of readers,
+// every one of them with its own cursor. The producer never waits: it overwrites the
+// oldest buffer, which no reader holds at the moment. Readers, which fall behind, lag or
+// skip buffers, but do not slow down the producer or the other readers.
+// Every reader holds at most one buffer, which is not overwritten until the reader
+// releases it or reads the next one.
+template<class T> class BroadcastBuffer {
+
+public:
+	BroadcastBuffer(const int bufferNumber, const int readerNumber);
+
+	BroadcastBuffer(const BroadcastBuffer&) = delete;
+	BroadcastBuffer& operator=(const BroadcastBuffer&) = delete;
+
+	// returns the same buffer until it is released
+	T& getWriteBuffer();
+	void releaseWriteBuffer();
+
+	// returns nullptr if the reader has seen all published buffers
+	const T* getReadBuffer(gsl::index reader, READ_POLICY policy = READ_POLICY::NEXT);
+	void releaseReadBuffer(gsl::index reader);
+	// only buffers published from now on are read
+	void skipPublished(gsl::index reader);
+
+	uint64_t getPublishedBuffers() const;
+	uint64_t getSkippedBuffers(gsl::index reader) const;
+
+private:
+	typedef struct SLOT {
+		T data;
+		std::atomic<uint64_t> sequence{ 0 };	// number of the published buffer, 0 while empty or being written
+	} SLOT;
+
+	typedef struct READER {
+		std::atomic<int> heldSlot{ -1 };		// slot the reader holds, -1 if none
+		uint64_t cursor{ 1 };					// sequence of the next buffer to read, only used by the reader
+		std::atomic<uint64_t> skippedBuffers{ 0 };
+	} READER;
+
+	bool isHeld(gsl::index slot) const;
+
+	const int m_bufferNumber;
+	const int m_readerNumber;
+	std::unique_ptr<SLOT[]> m_slots;
+	std::unique_ptr<READER[]> m_readers;
+	std::atomic<uint64_t> m_published{ 0 };		// sequence of the newest published buffer
+	int m_writeSlot{ -1 };						// slot the producer writes to, -1 if none
+};
+
+template<class T>
+inline BroadcastBuffer<T>::BroadcastBuffer(const int bufferNumber, const int readerNumber)
+	// every reader can hold a buffer and the producer needs one more to write to
+	: m_bufferNumber(std::max(bufferNumber, readerNumber + 2)), m_readerNumber(readerNumber),
+	m_slots(new SLOT[m_bufferNumber]), m_readers(new READER[readerNumber]) {
+}
+
+template<class T>
+inline T & BroadcastBuffer<T>::getWriteBuffer() {
+	while (m_writeSlot < 0) {
+		// overwrite the oldest buffer
+		gsl::index oldest{ -1 };
+		for (gsl::index i{ 0 }; i < m_bufferNumber; i++) {
+			if (!isHeld(i) && (oldest < 0 || m_slots[i].sequence.load() < m_slots[oldest].sequence.load())) {
+				oldest = i;
+			}
+		}
+		// Invalidate the slot before checking again, whether a reader holds it. A reader marks the slot
+		// as held before checking its sequence, so either the reader or the producer backs off.
+		uint64_t sequence = m_slots[oldest].sequence.exchange(0);
+		if (isHeld(oldest)) {
+			m_slots[oldest].sequence.store(sequence);
+		} else {
+			m_writeSlot = (int)oldest;
+		}
+	}
+	return m_slots[m_writeSlot].data;
+}
+
+template<class T>
+inline void BroadcastBuffer<T>::releaseWriteBuffer() {
+	if (m_writeSlot < 0) {
+		return;
+	}
+	uint64_t sequence = m_published.load(std::memory_order_relaxed) + 1;
+	m_slots[m_writeSlot].sequence.store(sequence);
+	m_published.store(sequence);
+	m_writeSlot = -1;
+}
+
+template<class T>
+inline const T * BroadcastBuffer<T>::getReadBuffer(gsl::index reader, READ_POLICY policy) {
+	READER& state = m_readers[reader];
+	releaseReadBuffer(reader);
+	while (true) {
+		uint64_t published = m_published.load();
+		if (published < state.cursor) {
+			return nullptr;
+		}
+
+		// find the newest buffer or the oldest one the reader has not seen yet
+		gsl::index found{ -1 };
+		uint64_t sequence{ 0 };
+		for (gsl::index i{ 0 }; i < m_bufferNumber; i++) {
+			uint64_t current = m_slots[i].sequence.load();
+			if (current < state.cursor || current > published) {
+				continue;
+			}
+			if (found < 0 || (policy == READ_POLICY::NEWEST) == (current > sequence)) {
+				found = i;
+				sequence = current;
+			}
+		}
+		if (found < 0) {
+			continue;
+		}
+
+		// the buffer might have been overwritten before it was marked as held
+		state.heldSlot.store((int)found);
+		if (m_slots[found].sequence.load() != sequence) {
+			state.heldSlot.store(-1);
+			continue;
+		}
+		state.skippedBuffers.fetch_add(sequence - state.cursor, std::memory_order_relaxed);
+		state.cursor = sequence + 1;
+		return &m_slots[found].data;
+	}
+}
+
+template<class T>
+inline void BroadcastBuffer<T>::releaseReadBuffer(gsl::index reader) {
+	m_readers[reader].heldSlot.store(-1);
+}
+
+template<class T>
+inline void BroadcastBuffer<T>::skipPublished(gsl::index reader) {
+	m_readers[reader].cursor = m_published.load() + 1;
+}
+
+template<class T>
+inline uint64_t BroadcastBuffer<T>::getPublishedBuffers() const {
+	return m_published.load(std::memory_order_relaxed);
+}
+
+template<class T>
+inline uint64_t BroadcastBuffer<T>::getSkippedBuffers(gsl::index reader) const {
+	return m_readers[reader].skippedBuffers.load(std::memory_order_relaxed);
+}
+
+template<class T>
+inline bool BroadcastBuffer<T>::isHeld(gsl::index slot) const {
+	for (gsl::index i{ 0 }; i < m_readerNumber; i++) {
+		if (m_readers[i].heldSlot.load() == slot) {
+			return true;
+		}
+	}
+	return false;
+}
+#endif //BROADCASTBUFFER_H
\ No newline at end of file
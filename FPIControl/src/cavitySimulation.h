@@ -0,0 +1,94 @@
+#ifndef CAVITYSIMULATION_H
+#define CAVITYSIMULATION_H
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+#define CAVITYSIMULATION_PI	3.14159265358979323846
+
+// Parameters of the simulated Fabry-Pérot cavity and the modulation.
+// The resonance position is given in units of the DAQ output voltage,
+// so that the locking loop can act on it via setOutputVoltage().
+typedef struct SIMULATION_PARAMETERS {
+	double finesse{ 50 };				// [1]	finesse of the cavity
+	double voltagePerFSR{ 1 };			// [V]	output voltage tuning the cavity by one free spectral range
+	double transmission{ 40 };			// [mV]	transmission signal on channel A on resonance
+	double detuning{ 0.005 };			// [V]	position of the resonance at t = 0
+	double drift{ 0.002 };				// [V/s]	linear drift of the resonance position
+	double modulationFrequency{ 5000 };	// [Hz]	frequency of the modulation
+	double modulationDepth{ 0.002 };	// [V]	amplitude of the modulation of the resonance position
+	double referenceAmplitude{ 400 };	// [mV]	amplitude of the reference signal on channel B
+	double referencePhase{ 0 };			// [degree]	phase shift between modulation and reference signal
+	double noise{ 0.5 };				// [mV]	standard deviation of the gaussian noise on both channels
+	uint32_t seed{ 0 };					//		seed of the random number generator
+} SIMULATION_PARAMETERS;
+
+// Transmission and reference signal of the cavity, independent of the DAQ, so that the
+// signal chain can be tested without hardware. The same parameters and seed always
+// produce the same signals.
+class CavitySimulation {
+
+public:
+	explicit CavitySimulation(const SIMULATION_PARAMETERS& parameters = SIMULATION_PARAMETERS()) {
+		setParameters(parameters);
+	};
+
+	// restart the simulation at t = 0
+	void setParameters(const SIMULATION_PARAMETERS& parameters) {
+		m_parameters = parameters;
+		m_time = 0;
+		m_outputVoltage = 0;
+		m_generator.seed(parameters.seed);
+		// the normal distribution requires a positive standard deviation
+		m_noise = std::normal_distribution<double>(0, (parameters.noise > 0) ? parameters.noise : 1);
+	};
+
+	const SIMULATION_PARAMETERS& getParameters() const noexcept { return m_parameters; };
+
+	void setOutputVoltage(double voltage) noexcept { m_outputVoltage = voltage; };
+
+	// the external trigger is the rising zero crossing of the reference signal
+	void waitForTrigger() {
+		double omega = 2 * CAVITYSIMULATION_PI * m_parameters.modulationFrequency;
+		double referencePhase = m_parameters.referencePhase * CAVITYSIMULATION_PI / 180;
+		if (omega > 0) {
+			m_time = (2 * CAVITYSIMULATION_PI * ceil((omega * m_time + referencePhase) / (2 * CAVITYSIMULATION_PI)) - referencePhase) / omega;
+		}
+	};
+
+	// [mV] Simulate no_of_samples samples of both signals, store(i, transmission, reference) is called for every sample.
+	template<class STORE>
+	void simulate(uint32_t no_of_samples, double samplingRate, STORE store) {
+		double dt = 1 / samplingRate;
+		double coefficient = pow(2 * m_parameters.finesse / CAVITYSIMULATION_PI, 2);
+		double omega = 2 * CAVITYSIMULATION_PI * m_parameters.modulationFrequency;
+		double referencePhase = m_parameters.referencePhase * CAVITYSIMULATION_PI / 180;
+		bool noisy = m_parameters.noise > 0;
+		for (uint32_t i{ 0 }; i < no_of_samples; i++) {
+			double t = m_time + i * dt;
+			// position of the resonance relative to the output voltage, including the modulation
+			double detuning = m_outputVoltage - m_parameters.detuning - m_parameters.drift * t
+				+ m_parameters.modulationDepth * sin(omega * t);
+			// Airy function of the cavity transmission
+			double phase = sin(CAVITYSIMULATION_PI * detuning / m_parameters.voltagePerFSR);
+			double transmission = m_parameters.transmission / (1 + coefficient * phase * phase);
+			double reference = m_parameters.referenceAmplitude * sin(omega * t + referencePhase);
+			if (noisy) {
+				transmission += m_noise(m_generator);
+				reference += m_noise(m_generator);
+			}
+			store(i, transmission, reference);
+		}
+		m_time += no_of_samples * dt;
+	};
+
+private:
+	SIMULATION_PARAMETERS m_parameters;
+	double m_outputVoltage{ 0 };	// [V]	voltage set by setOutputVoltage()
+	double m_time{ 0 };				// [s]	simulated time at the start of the next block
+	std::mt19937 m_generator;
+	std::normal_distribution<double> m_noise;
+};
+
+#endif // CAVITYSIMULATION_H
\ No newline at end of file
@@ -1,21 +1,45 @@
 #ifndef CIRCULARBUFFER_H
 #define CIRCULARBUFFER_H
 
-#include <QtCore>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
 #include <gsl/gsl>
+#include "alignedBuffer.h"
 
+#define CIRCULARBUFFER_ALIGNMENT		64					// [byte]	alignment of every channel
+
+typedef enum class OverflowPolicy {
+	OVERWRITE_OLDEST = 0,			// the producer never waits, the oldest unread buffer is dropped
+	BLOCK_PRODUCER = 1				// the producer waits until the consumer has read a buffer
+} OVERFLOW_POLICY;
+
+// Lock-free ring of buffers for a single producer and a single consumer thread.
+// Both sides get a buffer, fill or read it and release it afterwards. The consumer
+// holds at most one buffer, which is never overwritten while it is being read.
+// All buffers are stored in one slab indexed as [slot][channel][sample], every
+// channel starts at an aligned address. Large slabs are mapped in pages.
 template<class T> class CircularBuffer {
 
 public:
 	CircularBuffer() noexcept;
-	CircularBuffer(const int bufferNumber, const int bufferWidth, const int bufferLength);
-	~CircularBuffer();
+	CircularBuffer(const int bufferNumber, const int bufferWidth, const int bufferLength,
+		const OVERFLOW_POLICY policy = OVERFLOW_POLICY::OVERWRITE_OLDEST);
+
+	CircularBuffer(const CircularBuffer&) = delete;
+	CircularBuffer& operator=(const CircularBuffer&) = delete;
 
+	// returns nullptr if the buffer to write has to be dropped
 	T** getWriteBuffer();
+	void releaseWriteBuffer();
+	// returns nullptr if there is no unread buffer
 	T** getReadBuffer();
+	void releaseReadBuffer();
 
-	QSemaphore* m_freeBuffers;
-	QSemaphore* m_usedBuffers = new QSemaphore;
+	unsigned int getDroppedBuffers() const;
+	std::size_t getStride() const;
 
 	T*** m_buffers;
 
@@ -24,25 +48,38 @@ private:
 	const int m_bufferNumber;
 	const int m_bufferLength;
 	const int m_bufferWidth;
-	unsigned int m_writeCount{ 0 };
-	unsigned int m_readCount{ 0 };
+	const OVERFLOW_POLICY m_policy{ OVERFLOW_POLICY::OVERWRITE_OLDEST };
+	std::atomic<unsigned int> m_writeCount{ 0 };		// number of written buffers, only changed by the producer
+	std::atomic<unsigned int> m_readCount{ 0 };			// number of read or dropped buffers
+	std::atomic<int64_t> m_heldBuffer{ -1 };			// count of the buffer the consumer reads, -1 if none
+	std::atomic<unsigned int> m_droppedBuffers{ 0 };
+
+	AlignedBuffer<T, CIRCULARBUFFER_ALIGNMENT> m_slab;	// storage of all buffers
+	std::vector<T*> m_channels;				// start of every channel in the slab
+	std::vector<T**> m_slots;				// channels of every slot
+	std::size_t m_stride{ 0 };				// number of elements from one channel to the next
 };
 
 template<class T>
-inline CircularBuffer<T>::CircularBuffer() noexcept : m_bufferNumber(0), m_bufferWidth(0), m_bufferLength(0), m_freeBuffers(new QSemaphore(0)) {
+inline CircularBuffer<T>::CircularBuffer() noexcept : m_bufferNumber(0), m_bufferLength(0), m_bufferWidth(0) {
 	m_buffers = nullptr;
 }
 
 template<class T>
-inline CircularBuffer<T>::CircularBuffer(const int bufferNumber, const int bufferWidth, const int bufferLength)
-	: m_bufferNumber(checkBufferNumber(bufferNumber)), m_bufferLength(bufferLength), m_bufferWidth(bufferWidth),
-	m_freeBuffers(new QSemaphore(checkBufferNumber(bufferNumber))) {
+inline CircularBuffer<T>::CircularBuffer(const int bufferNumber, const int bufferWidth, const int bufferLength, const OVERFLOW_POLICY policy)
+	: m_bufferNumber(checkBufferNumber(bufferNumber)), m_bufferLength(bufferLength), m_bufferWidth(bufferWidth), m_policy(policy) {
+
+	// pad the channels to a multiple of the alignment
+	m_stride = ((m_bufferLength * sizeof(T) + CIRCULARBUFFER_ALIGNMENT - 1) / CIRCULARBUFFER_ALIGNMENT) * CIRCULARBUFFER_ALIGNMENT / sizeof(T);
+	m_slab.resize((std::size_t)m_bufferNumber * m_bufferWidth * m_stride);
 
-	m_buffers = new T**[m_bufferNumber];
+	m_channels.resize((std::size_t)m_bufferNumber * m_bufferWidth);
+	m_slots.resize(m_bufferNumber);
+	m_buffers = m_slots.data();
 	for (gsl::index i{ 0 }; i < m_bufferNumber; i++) {
-		m_buffers[i] = new T*[m_bufferWidth];
+		m_buffers[i] = &m_channels[i * m_bufferWidth];
 		for (gsl::index j{ 0 }; j < m_bufferWidth; j++) {
-			m_buffers[i][j] = new T[m_bufferLength];
+			m_buffers[i][j] = &m_slab[(i * m_bufferWidth + j) * m_stride];
 		}
 	}
 }
@@ -54,24 +91,64 @@ inline int CircularBuffer<T>::checkBufferNumber(int bufferNumber) {
 }
 
 template<class T>
-inline CircularBuffer<T>::~CircularBuffer() {
-	for (gsl::index i{ 0 }; i < m_bufferNumber; i++) {
-		delete[] m_buffers[i];
+inline T ** CircularBuffer<T>::getWriteBuffer() {
+	unsigned int write = m_writeCount.load(std::memory_order_relaxed);
+	while (true) {
+		// m_readCount has to be loaded first, the consumer marks a buffer as held before claiming it
+		unsigned int read = m_readCount.load();
+		int64_t held = m_heldBuffer.load();
+		unsigned int oldest = (held >= 0) ? (unsigned int)held : read;
+		if (write - oldest < (unsigned int)m_bufferNumber) {
+			return m_buffers[write % m_bufferNumber];
+		}
+
+		if (m_policy == OVERFLOW_POLICY::BLOCK_PRODUCER) {
+			// wait until the consumer claims or releases a buffer
+			std::this_thread::yield();
+		} else if (oldest == read) {
+			// drop the oldest unread buffer, unless the consumer claimed it in the meantime
+			if (m_readCount.compare_exchange_strong(read, read + 1)) {
+				m_droppedBuffers++;
+			}
+		} else {
+			// the buffer to overwrite is being read, so drop the new one instead
+			m_droppedBuffers++;
+			return nullptr;
+		}
 	}
-	delete[] m_buffers;
-	delete m_freeBuffers;
-	delete m_usedBuffers;
 }
 
 template<class T>
-inline T ** CircularBuffer<T>::getWriteBuffer() {
-	// return pointer to buffer and increment m_writeCount
-	return m_buffers[m_writeCount++ % m_bufferNumber];
+inline void CircularBuffer<T>::releaseWriteBuffer() {
+	// publish the buffer returned by getWriteBuffer()
+	m_writeCount.fetch_add(1);
 }
 
 template<class T>
 inline T ** CircularBuffer<T>::getReadBuffer() {
-	// return pointer to buffer and increment m_readCount
-	return m_buffers[m_readCount++ % m_bufferNumber];
+	unsigned int read = m_readCount.load();
+	do {
+		if (read == m_writeCount.load()) {
+			releaseReadBuffer();
+			return nullptr;
+		}
+		m_heldBuffer.store(read);
+	} while (!m_readCount.compare_exchange_weak(read, read + 1));
+	return m_buffers[read % m_bufferNumber];
+}
+
+template<class T>
+inline void CircularBuffer<T>::releaseReadBuffer() {
+	m_heldBuffer.store(-1);
+}
+
+template<class T>
+inline unsigned int CircularBuffer<T>::getDroppedBuffers() const {
+	return m_droppedBuffers.load(std::memory_order_relaxed);
+}
+
+template<class T>
+inline std::size_t CircularBuffer<T>::getStride() const {
+	return m_stride;
 }
 #endif //CIRCULARBUFFER_H
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef CONVERSION_H
+#define CONVERSION_H
+
+#include <cstdint>
+#include <algorithm>
+#include <gsl/gsl>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONVERSION_SSE2
+#include <emmintrin.h>
+#endif
+
+// Conversion of whole channel buffers from ADC counts to voltages.
+// The instruction set is chosen at compile time: AVX2 if enabled (/arch:AVX2),
+// SSE2 on every x64 build and a scalar loop otherwise.
+class conversion {
+public:
+	// [mV] = raw * range / 32767, truncated like the integer calculation in daq::adc_to_mv()
+	static void adcToMillivolt(gsl::span<const int16_t> raw, gsl::span<int32_t> mv, int32_t range) {
+		const gsl::index length = std::min(raw.size(), mv.size());
+		gsl::index i{ 0 };
+		// The product raw * range is exact in double precision and a quotient, which is not
+		// an integer, is at least 1/32767 away from the next integer, so truncating the
+		// correctly rounded quotient gives the same result as the integer division.
+#if defined(__AVX2__)
+		const __m256d factor = _mm256_set1_pd(range);
+		const __m256d divisor = _mm256_set1_pd(32767.0);
+		for (; i + 8 <= length; i += 8) {
+			__m256i values = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&raw[i])));
+			__m256d low = _mm256_div_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(values)), factor), divisor);
+			__m256d high = _mm256_div_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(values, 1)), factor), divisor);
+			__m256i result = _mm256_set_m128i(_mm256_cvttpd_epi32(high), _mm256_cvttpd_epi32(low));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&mv[i]), result);
+		}
+#elif defined(CONVERSION_SSE2)
+		const __m128d factor = _mm_set1_pd(range);
+		const __m128d divisor = _mm_set1_pd(32767.0);
+		for (; i + 8 <= length; i += 8) {
+			__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&raw[i]));
+			// sign extend to 32 bit
+			__m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+			__m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&mv[i]), convert(low, factor, divisor));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&mv[i + 4]), convert(high, factor, divisor));
+		}
+#endif
+		for (; i < length; i++) {
+			mv[i] = (raw[i] * range) / 32767;
+		}
+	}
+
+	// [V] = raw * range / 32767 / 1000
+	static void adcToVolt(gsl::span<const int16_t> raw, gsl::span<float> volt, int32_t range) {
+		const gsl::index length = std::min(raw.size(), volt.size());
+		const float scale = range / 32767e3f;
+		gsl::index i{ 0 };
+#if defined(__AVX2__)
+		const __m256 factor = _mm256_set1_ps(scale);
+		for (; i + 8 <= length; i += 8) {
+			__m256i values = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&raw[i])));
+			_mm256_storeu_ps(&volt[i], _mm256_mul_ps(_mm256_cvtepi32_ps(values), factor));
+		}
+#elif defined(CONVERSION_SSE2)
+		const __m128 factor = _mm_set1_ps(scale);
+		for (; i + 8 <= length; i += 8) {
+			__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&raw[i]));
+			__m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+			__m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16);
+			_mm_storeu_ps(&volt[i], _mm_mul_ps(_mm_cvtepi32_ps(low), factor));
+			_mm_storeu_ps(&volt[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(high), factor));
+		}
+#endif
+		for (; i < length; i++) {
+			volt[i] = raw[i] * scale;
+		}
+	}
+
+	// copy the raw ADC counts without scaling
+	static void adcToCounts(gsl::span<const int16_t> raw, gsl::span<int32_t> counts) {
+		std::copy_n(raw.begin(), std::min(raw.size(), counts.size()), counts.begin());
+	}
+
+private:
+#if defined(CONVERSION_SSE2)
+	// convert four 32 bit integers to mV
+	static __m128i convert(__m128i values, __m128d factor, __m128d divisor) {
+		__m128d low = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(values), factor), divisor);
+		__m128d high = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(values, _MM_SHUFFLE(1, 0, 3, 2))), factor), divisor);
+		return _mm_unpacklo_epi64(_mm_cvttpd_epi32(low), _mm_cvttpd_epi32(high));
+	}
+#endif
+};
+
+#endif // CONVERSION_H
\ No newline at end of file
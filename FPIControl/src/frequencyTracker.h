@@ -0,0 +1,118 @@
+#ifndef FREQUENCYTRACKER_H
+#define FREQUENCYTRACKER_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <gsl/gsl>
+
+#define FREQUENCYTRACKER_BINS		5							//			number of frequencies evaluated around the current estimate
+#define FREQUENCYTRACKER_SPACING	0.5							// [bins]	distance of the frequencies in units of the DFT resolution
+#define FREQUENCYTRACKER_RANGE		0.1							// [1]		maximum relative deviation from the nominal frequency
+#define FREQUENCYTRACKER_TWO_PI		6.283185307179586476925		// [rad]	one period
+
+// Estimate of the modulation
+typedef struct FREQUENCY_ESTIMATE {
+	double frequency{ NAN };	// [Hz]
+	double phase{ NAN };		// [degree]	phase of a cosine at the first sample
+	double amplitude{ NAN };	//			amplitude in units of the signal
+} FREQUENCY_ESTIMATE;
+
+// Follows the frequency of a sinusoidal signal, e.g. the measured reference, from block to block.
+// Instead of a full FFT only a few frequencies around the last estimate are evaluated with the
+// Goertzel algorithm, which costs O(n) per frequency, in a single pass over the signal.
+// The peak is interpolated between the frequencies. A drift larger than the evaluated range
+// is followed over several blocks.
+class FrequencyTracker {
+
+public:
+	FrequencyTracker() noexcept {};
+
+	// [Hz] the estimate is reset if the nominal frequency changes
+	FREQUENCY_ESTIMATE update(gsl::span<const int32_t> signal, double nominalFrequency, double samplingRate) {
+		if (nominalFrequency != m_nominalFrequency || !(m_frequency > 0)) {
+			m_nominalFrequency = nominalFrequency;
+			m_frequency = nominalFrequency;
+		}
+		const gsl::index length = signal.size();
+		if (length < 2 || !(samplingRate > 0) || !(nominalFrequency > 0)) {
+			return m_estimate;
+		}
+
+		// [rad/sample] angular frequencies to evaluate
+		const double resolution = FREQUENCYTRACKER_TWO_PI / length;
+		const double center = FREQUENCYTRACKER_TWO_PI * m_frequency / samplingRate;
+		std::array<double, FREQUENCYTRACKER_BINS> omega;
+		std::array<double, FREQUENCYTRACKER_BINS> coefficient;
+		for (gsl::index k{ 0 }; k < FREQUENCYTRACKER_BINS; k++) {
+			omega[k] = center + (k - (FREQUENCYTRACKER_BINS - 1) / 2) * FREQUENCYTRACKER_SPACING * resolution;
+			coefficient[k] = 2 * cos(omega[k]);
+		}
+
+		// all Goertzel filters run in the same pass, so that their recursions are independent
+		std::array<double, FREQUENCYTRACKER_BINS> previous{};
+		std::array<double, FREQUENCYTRACKER_BINS> beforePrevious{};
+		for (gsl::index i{ 0 }; i < length; i++) {
+			double value = signal[i];
+			for (gsl::index k{ 0 }; k < FREQUENCYTRACKER_BINS; k++) {
+				double current = value + coefficient[k] * previous[k] - beforePrevious[k];
+				beforePrevious[k] = previous[k];
+				previous[k] = current;
+			}
+		}
+
+		// DFT of the signal at the evaluated frequencies
+		std::array<std::complex<double>, FREQUENCYTRACKER_BINS> spectrum;
+		gsl::index peak{ 0 };
+		for (gsl::index k{ 0 }; k < FREQUENCYTRACKER_BINS; k++) {
+			spectrum[k] = std::polar(1.0, -omega[k] * (length - 1)) *
+				(previous[k] - std::polar(1.0, -omega[k]) * beforePrevious[k]);
+			if (std::abs(spectrum[k]) > std::abs(spectrum[peak])) {
+				peak = k;
+			}
+		}
+		if (std::abs(spectrum[peak]) == 0) {
+			return m_estimate;
+		}
+
+		// parabolic interpolation of the magnitude around the peak
+		double offset{ 0 };
+		if (peak > 0 && peak < FREQUENCYTRACKER_BINS - 1) {
+			double left = std::abs(spectrum[peak - 1]);
+			double middle = std::abs(spectrum[peak]);
+			double right = std::abs(spectrum[peak + 1]);
+			double curvature = left - 2 * middle + right;
+			if (curvature < 0) {
+				offset = std::clamp(0.5 * (left - right) / curvature, -0.5, 0.5);
+			}
+		}
+		double delta = offset * FREQUENCYTRACKER_SPACING * resolution;
+		double frequency = (omega[peak] + delta) * samplingRate / FREQUENCYTRACKER_TWO_PI;
+		// do not follow other signals too far from the nominal frequency
+		frequency = std::clamp(frequency, (1 - FREQUENCYTRACKER_RANGE) * m_nominalFrequency,
+			(1 + FREQUENCYTRACKER_RANGE) * m_nominalFrequency);
+		delta = FREQUENCYTRACKER_TWO_PI * frequency / samplingRate - omega[peak];
+
+		// the DFT of a cosine at a slightly different frequency is rotated by half the phase accumulated
+		// over the block and attenuated by the Dirichlet kernel
+		double dirichlet = (std::abs(delta) > 1e-12) ? sin(length * delta / 2) / sin(delta / 2) : (double)length;
+		std::complex<double> phasor = spectrum[peak] * std::polar(1.0, -delta * (length - 1) / 2);
+		m_frequency = frequency;
+		m_estimate.frequency = frequency;
+		m_estimate.phase = std::arg(phasor) * 360 / FREQUENCYTRACKER_TWO_PI;
+		m_estimate.amplitude = 2 * std::abs(phasor) / std::abs(dirichlet);
+		return m_estimate;
+	};
+
+	// [Hz]
+	double getFrequency() const noexcept { return m_frequency; };
+	const FREQUENCY_ESTIMATE& getEstimate() const noexcept { return m_estimate; };
+
+private:
+	double m_nominalFrequency{ 0 };		// [Hz]
+	double m_frequency{ 0 };			// [Hz]	current estimate, the center of the evaluated frequencies
+	FREQUENCY_ESTIMATE m_estimate;
+};
+
+#endif // FREQUENCYTRACKER_H
\ No newline at end of file
@@ -12,43 +12,58 @@
 
 class generalmath {
 public:
-	static double mean(std::vector<int> vector) {
-		return std::accumulate(std::begin(vector), std::end(vector), 0.0) / vector.size();
+	// All functions take spans, so that vectors and other contiguous storage are passed without copying.
+
+	static double mean(gsl::span<const int> values) {
+		return std::accumulate(std::begin(values), std::end(values), 0.0) / values.size();
+	}
+
+	static double mean(gsl::span<const double> values) {
+		return std::accumulate(std::begin(values), std::end(values), 0.0) / values.size();
 	}
 
-	static double mean(std::vector<double> vector) {
-		return std::accumulate(std::begin(vector), std::end(vector), 0.0) / vector.size();
+	static std::complex<double> mean(gsl::span<const std::complex<double>> values) {
+		return std::accumulate(std::begin(values), std::end(values), std::complex<double>(0.0, 0.0)) / std::complex<double>(values.size(), 0);
 	}
 
-	static std::complex<double> mean(std::vector<std::complex<double>> vector) {
-		return std::accumulate(std::begin(vector), std::end(vector), std::complex<double>(0.0, 0.0)) / std::complex<double>(vector.size(), 0);
+	template <typename T = double>
+	static T max(gsl::span<const T> values) {
+		return *std::max_element(std::begin(values), std::end(values));
 	}
 
 	template <typename T = double>
-	static T maximum(std::vector<T> vector) {
-		auto result = std::max_element(std::begin(vector), std::end(vector));
-		return *result;
+	static T max(const std::vector<T>& vector) {
+		return max<T>(gsl::span<const T>(vector));
 	}
 
 	template <typename T = double>
-	static T minimum(std::vector<T> vector) {
-		auto result = std::min_element(std::begin(vector), std::end(vector));
-		return *result;
+	static T min(gsl::span<const T> values) {
+		return *std::min_element(std::begin(values), std::end(values));
 	}
 
 	template <typename T = double>
-	static T absSum(std::vector<T> vector) {
+	static T min(const std::vector<T>& vector) {
+		return min<T>(gsl::span<const T>(vector));
+	}
+
+	template <typename T = double>
+	static T absSum(gsl::span<const T> values) {
 		T sum{ 0 };
-		for (int jj{ 0 }; jj < vector.size(); jj++) {
-			sum += abs(vector[jj]);
+		for (const T& value : values) {
+			sum += abs(value);
 		}
 		return sum;
 	}
 
-	static double floatingMean(std::vector<double> vector, size_t nrValues, size_t offset = 0) {
+	template <typename T = double>
+	static T absSum(const std::vector<T>& vector) {
+		return absSum<T>(gsl::span<const T>(vector));
+	}
+
+	static double floatingMean(gsl::span<const double> values, size_t nrValues, size_t offset = 0) {
 		// If we request a floating mean over all or more elements, just return the global mean.
-		if (nrValues >= vector.size()) {
-			return mean(vector);
+		if (nrValues >= values.size()) {
+			return mean(values);
 		}
 		// Floating mean over no element is NaN.
 		if (nrValues == 0) {
@@ -56,94 +71,97 @@ public:
 		}
 
 		// If the index of the first element is positive we only need one accumulator
-		if (vector.size() >= offset + nrValues) {
-			return std::accumulate(std::prev(vector.end(), offset + nrValues), std::prev(vector.end(), offset), 0.0) / nrValues;
+		if (values.size() >= offset + nrValues) {
+			return std::accumulate(std::prev(values.end(), offset + nrValues), std::prev(values.end(), offset), 0.0) / nrValues;
 		// Else, we wrap around and also average elements from the end of the vector
 		} else {
 			return (
-					std::accumulate(vector.begin(), std::prev(vector.end(), offset), 0.0) +
-					std::accumulate(std::prev(vector.end(), nrValues + offset - vector.size()), vector.end(), 0.0)
+					std::accumulate(values.begin(), std::prev(values.end(), offset), 0.0) +
+					std::accumulate(std::prev(values.end(), nrValues + offset - values.size()), values.end(), 0.0)
 				) / nrValues;
 		}
 	}
 
-	static double standardDeviation(std::vector<double> vector) {
-		if (vector.size() == 0) {
+	static double standardDeviation(gsl::span<const double> values) {
+		if (values.size() == 0) {
 			return nan("1");
 		}
-		double m = mean(vector);
+		double m = mean(values);
 		double accum{ 0.0 };
-		std::for_each(std::begin(vector), std::end(vector), [&](const double d) {
+		std::for_each(std::begin(values), std::end(values), [&](const double d) {
 			accum += (d - m) * (d - m);
 		});
 
-		return sqrt(accum / (vector.size() - 1));
+		return sqrt(accum / (values.size() - 1));
 	}
 
-	static double floatingStandardDeviation(std::vector<double> vector, size_t nrValues, size_t offset = 0) {
+	static double floatingStandardDeviation(gsl::span<const double> values, size_t nrValues, size_t offset = 0) {
 		// If we request a floating standard deviation over all or more elements, just return the global standard deviation.
-		if (nrValues >= vector.size()) {
-			return standardDeviation(vector);
+		if (nrValues >= values.size()) {
+			return standardDeviation(values);
 		}
 		// Floating standard deviation over no element is NaN.
-		if (vector.size() == 0) {
+		if (values.size() == 0) {
 			return nan("1");
 		}
-		double m = floatingMean(vector, nrValues, offset);
+		double m = floatingMean(values, nrValues, offset);
 		auto std_sum = [&](double a, double value) {
 			return std::move(a) + ((value - m) * (value - m));
 		};
 		auto accum{ 0.0 };
 		// If the index of the first element is positive we only need one accumulator
-		if (vector.size() >= offset + nrValues) {
-			accum = std::accumulate(std::prev(vector.end(), offset + nrValues), std::prev(vector.end(), offset), 0.0, std_sum);
+		if (values.size() >= offset + nrValues) {
+			accum = std::accumulate(std::prev(values.end(), offset + nrValues), std::prev(values.end(), offset), 0.0, std_sum);
 		} else {
-			accum = std::accumulate(vector.begin(), std::prev(vector.end(), offset), 0.0, std_sum) +
-				std::accumulate(std::prev(vector.end(), nrValues + offset - vector.size()), vector.end(), 0.0, std_sum);
+			accum = std::accumulate(values.begin(), std::prev(values.end(), offset), 0.0, std_sum) +
+				std::accumulate(std::prev(values.end(), nrValues + offset - values.size()), values.end(), 0.0, std_sum);
 		}
 
 		return sqrt(accum / (nrValues - 1));
 	}
 
-	static double floatingMax(std::vector<double> vector, size_t nrValues) {
-		if (vector.size() == 0) {
+	static double floatingMax(gsl::span<const double> values, size_t nrValues) {
+		if (values.size() == 0) {
 			return nan("1");
 		}
-		nrValues = (nrValues > vector.size()) ? vector.size() : nrValues;
-		double max = *std::prev(std::end(vector), nrValues);
-		std::for_each(std::prev(std::end(vector), nrValues), std::end(vector), [&](const double d) {
-			if (d > max) {
-				max = d;
-			}
-		});
-		return max;
+		nrValues = (nrValues > values.size()) ? values.size() : nrValues;
+		return *std::max_element(std::prev(std::end(values), nrValues), std::end(values));
 	}
 
-	static int32_t floatingMax(std::vector<int32_t> vector, size_t nrValues) {
-		if (vector.size() == 0) {
+	static int32_t floatingMax(gsl::span<const int32_t> values, size_t nrValues) {
+		if (values.size() == 0) {
 			// should return NaN, but there is no NaN implementation for int/int32_t
 			return 0;
 		}
-		nrValues = (nrValues > vector.size()) ? vector.size() : nrValues;
-		int32_t max = *std::prev(std::end(vector), nrValues);
-		std::for_each(std::prev(std::end(vector), nrValues), std::end(vector), [&](const int32_t d) {
-			if (d > max) {
-				max = d;
-			}
-		});
-		return max;
+		nrValues = (nrValues > values.size()) ? values.size() : nrValues;
+		return *std::max_element(std::prev(std::end(values), nrValues), std::end(values));
+	}
+
+	// fill the values linearly spaced from min to max
+	template <typename T = double>
+	static void linspace(T min, T max, gsl::span<T> values) {
+		if (values.size() == 1) {
+			values[0] = min;
+			return;
+		}
+		T spacing = (max - min) / static_cast<T>(values.size() - 1);
+		for (gsl::index i{ 0 }; i < (gsl::index)values.size(); i++) {
+			values[i] = min + i * spacing;
+		}
+	}
+
+	// resize the vector to N values linearly spaced from min to max, keeps its capacity
+	template <typename T = double>
+	static void linspace(T min, T max, size_t N, std::vector<T>& values) {
+		values.resize(N);
+		linspace<T>(min, max, gsl::span<T>(values));
 	}
 
 	// return linearly spaced vector
 	template <typename T = double>
 	static std::vector<T> linspace(T min, T max, size_t N) {
-		T spacing = (max - min) / static_cast<T>(N - 1);
 		std::vector<T> xs(N);
-		typename std::vector<T>::iterator x;
-		T value;
-		for (x = xs.begin(), value = min; x != xs.end(); ++x, value += spacing) {
-			*x = value;
-		}
+		linspace<T>(min, max, gsl::span<T>(xs));
 		return xs;
 	}
 
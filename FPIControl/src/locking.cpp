@@ -13,7 +13,14 @@ Locking::Locking(QObject *parent, daq **dataAcquisition, kcubepiezo **piezoContr
 	lockData.voltagePiezo.resize(lockData.storageSize);
 	lockData.amplitude.resize(lockData.storageSize);
 	lockData.error.resize(lockData.storageSize);
+	lockData.inPhase.resize(lockData.storageSize);
+	lockData.quadrature.resize(lockData.storageSize);
 	lockData.startTime = std::chrono::system_clock::now();
+	for (gsl::index window{ 0 }; window < (gsl::index)STATISTICS_WINDOW::COUNT; window++) {
+		setStatisticsWindow((STATISTICS_WINDOW)window, lockSettings.statisticsWindows[window]);
+	}
+	lockData.amplitudeExtrema.setWindow((size_t)round(1000 * lockSettings.amplitudeTimeout / lockSettings.lockingTimeout),
+		lockData.amplitude, 0, 0);
 }
 
 void Locking::startStopAcquireLocking() {
@@ -21,8 +28,20 @@ void Locking::startStopAcquireLocking() {
 		setLockState(LOCKSTATE::INACTIVE);
 		m_isAcquireLockingRunning = false;
 		lockingTimer->stop();
+		(*m_dataAcquisition)->setPipelining(false);
+		(*m_dataAcquisition)->setConsumerActive(DAQ_CONSUMER::LOCKING, false);
+		setReferenceFree(false);
 	} else {
 		m_isAcquireLockingRunning = true;
+		// the reference can only be synthesised once its phase at the trigger is known,
+		// the faster timebases without the reference channel are then taken into account by the plan
+		setReferenceFree(lockSettings.referenceFree && !std::isnan(lockSettings.referencePhase)
+			&& !std::isnan(lockSettings.referenceAmplitude));
+		planAcquisition();
+		// optionally capture the next block while the current one is processed,
+		// the error signal then lags one locking run behind the output voltage
+		(*m_dataAcquisition)->setPipelining(lockSettings.pipelined);
+		(*m_dataAcquisition)->setConsumerActive(DAQ_CONSUMER::LOCKING, true);
 		lockingTimer->start(lockSettings.lockingTimeout);
 	}
 	emit(s_acquireLockingRunning(m_isAcquireLockingRunning));
@@ -49,11 +68,51 @@ void Locking::toggleOffsetCompensation(bool compensate) {
 	lockSettings.compensate = compensate;
 }
 
+// applied on the next start of a scan, which calibrates the reference, or of the locking acquisition
+void Locking::toggleReferenceFree(bool referenceFree) {
+	lockSettings.referenceFree = referenceFree;
+}
+
+// The locking runs are paced by the timer, so a pipelined block is captured right after the previous run
+// and acts on data, which predates the last correction. Only worth it if the timeout is below the block duration.
+// Applied on the next start of the locking acquisition.
+void Locking::togglePipelining(bool pipelined) {
+	lockSettings.pipelined = pipelined;
+}
+
+// Without the reference channel the acquisition has to be triggered on the modulation, so that every segment
+// starts at the calibrated phase. A single channel halves the transfer per block and allows the faster
+// timebases of the PS2000 series.
+void Locking::setReferenceFree(bool referenceFree) {
+	if (referenceFree == m_referenceFree) {
+		return;
+	}
+	m_referenceFree = referenceFree;
+	(*m_dataAcquisition)->setChannelEnabled(1, !referenceFree);
+	(*m_dataAcquisition)->setTrigger(referenceFree ? TRIGGER_SOURCE::EXTERNAL : TRIGGER_SOURCE::NONE);
+}
+
+// The phasors of the reference at the trigger are averaged over all passes of the scan. They are only used
+// if the scan was completed.
+void Locking::stopCalibration(bool completed) {
+	if (!m_calibrating) {
+		return;
+	}
+	m_calibrating = false;
+	if (completed && m_referencePhasorCount > 0) {
+		std::complex<double> phasor = m_referencePhasor / (double)m_referencePhasorCount;
+		lockSettings.referencePhase = std::arg(phasor) / PDH_DEGREE;
+		lockSettings.referenceAmplitude = std::abs(phasor);
+	}
+	(*m_dataAcquisition)->setTrigger(TRIGGER_SOURCE::NONE);
+}
+
 void Locking::disableLocking(LOCKSTATE lockstate) {
 	(*m_piezoControl)->setVoltageSource(PZ_InputSourceFlags::PZ_ExternalSignal);
 	m_daqVoltage = 0;
 	// set output voltage of the DAQ
 	(*m_dataAcquisition)->setOutputVoltage(m_daqVoltage);
+	(*m_dataAcquisition)->discardArmedBlock();
 	lockSettings.compensating = false;
 	emit(compensationStateChanged(false));
 	
@@ -106,21 +165,45 @@ void Locking::setLockParameters(LOCKPARAMETERS type, double value) {
 	}
 }
 
+// [s] the statistics are recalculated once, afterwards they are updated in constant time
+void Locking::setStatisticsWindow(STATISTICS_WINDOW window, double duration) {
+	lockSettings.statisticsWindows[(int)window] = duration;
+	size_t nrValues = (size_t)round(1000 * duration / lockSettings.lockingTimeout);
+	auto lastIndex = generalmath::indexWrapped((int)lockData.nextIndex - 1, lockData.storageSize);
+	lockData.errorStatistics[(int)window].setWindow(nrValues, lockData.error, lastIndex, lockData.count);
+}
+
 void Locking::startScan() {
 	if (scanTimer->isActive()) {
 		scanData.m_running = false;
 		scanTimer->stop();
+		(*m_dataAcquisition)->setConsumerActive(DAQ_CONSUMER::SCAN, false);
+		stopCalibration(false);
 		emit s_scanRunning(scanData.m_running);
 	} else {
 		// prepare data arrays
 		scanData.nrSteps = scanSettings.nrSteps;
-		scanData.voltages = generalmath::linspace<double>(scanSettings.low, scanSettings.high, scanSettings.nrSteps);
+		generalmath::linspace<double>(scanSettings.low, scanSettings.high, scanSettings.nrSteps, scanData.voltages);
 
 		scanData.intensity.resize(scanSettings.nrSteps);
 		scanData.error.resize(scanSettings.nrSteps);
+		scanData.quadrature.resize(scanSettings.nrSteps);
 		std::fill(scanData.intensity.begin(), scanData.intensity.end(), NAN);
 		std::fill(scanData.error.begin(), scanData.error.end(), NAN);
-
+		std::fill(scanData.quadrature.begin(), scanData.quadrature.end(), NAN);
+
+		// every block has to be captured after the piezo voltage was set
+		(*m_dataAcquisition)->setPipelining(false);
+		(*m_dataAcquisition)->setConsumerActive(DAQ_CONSUMER::SCAN, true);
+		// the scan needs the reference, which is calibrated for the reference-free locking with the triggered acquisition
+		setReferenceFree(false);
+		m_calibrating = lockSettings.referenceFree;
+		m_referencePhasor = 0;
+		m_referencePhasorCount = 0;
+		if (m_calibrating) {
+			(*m_dataAcquisition)->setTrigger(TRIGGER_SOURCE::EXTERNAL);
+		}
+		planAcquisition();
 		(*m_dataAcquisition)->setAcquisitionParameters();
 
 		scanData.pass = 0;
@@ -128,6 +211,7 @@ void Locking::startScan() {
 		scanData.m_abort = false;
 		// set piezo voltage to start value
 		(*m_piezoControl)->setVoltage(scanData.voltages[scanData.pass]);
+		(*m_dataAcquisition)->discardArmedBlock();
 		passTimer.start();
 		scanTimer->start(1000);
 		emit s_scanRunning(scanData.m_running);
@@ -139,6 +223,8 @@ void Locking::scan() {
 	if (scanData.m_abort) {
 		scanData.m_running = false;
 		scanTimer->stop();
+		(*m_dataAcquisition)->setConsumerActive(DAQ_CONSUMER::SCAN, false);
+		stopCalibration(false);
 		emit s_scanRunning(scanData.m_running);
 	}
 
@@ -150,33 +236,38 @@ void Locking::scan() {
 	// reset timer when enough time has passed
 	passTimer.start();
 
-	// acquire detector and reference signal, store and process it
-	std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> values = (*m_dataAcquisition)->collectBlockData();
-
-	std::vector<double> tau(values[0].begin(), values[0].end());
-	std::vector<double> reference(values[1].begin(), values[1].end());
-
-	double tau_max = generalmath::maximum(tau);
-	double tau_min = generalmath::minimum(tau);
-
-	// normalize transmission signal
-	std::transform(tau.begin(), tau.end(), tau.begin(),
-		[tau_max, tau_min](double &el) {
-			return (el - tau_min) / (tau_max - tau_min);
-		}
-	);
+	// acquire detector and reference signal, store and process it,
+	// blocks acquired before the interval has passed do not belong to the voltage
+	(*m_dataAcquisition)->skipBlocks(DAQ_CONSUMER::SCAN);
+	const DAQ_BLOCK* block = (*m_dataAcquisition)->acquireBlock(DAQ_CONSUMER::SCAN);
+	if (!block) {
+		return;
+	}
 
-	scanData.intensity[scanData.pass] = generalmath::absSum(tau);
-	scanData.error[scanData.pass] = pdh.getError(tau, reference);
+	updateReference(*block);
+	PDH_RESULT result = demodulate(*block);
+	(*m_dataAcquisition)->releaseBlock(DAQ_CONSUMER::SCAN);
+
+	// the normalized values are not negative, so their sum follows from the sum of the raw values
+	scanData.intensity[scanData.pass] = (result.sum - result.count * result.min) / result.amplitude();
+	scanData.error[scanData.pass] = result.inPhase;
+	scanData.quadrature[scanData.pass] = result.quadrature;
+	if (m_calibrating && !std::isnan(lockData.modulation.phase)) {
+		m_referencePhasor += std::polar(lockData.modulation.amplitude, lockData.modulation.phase * PDH_DEGREE);
+		m_referencePhasorCount++;
+	}
 
 	++scanData.pass;
 	emit s_scanPassAcquired();
 	// if scan is not done, set temperature to new value, else annouce finished scan
 	if (scanData.pass < scanData.nrSteps) {
 		(*m_piezoControl)->setVoltage(scanData.voltages[scanData.pass]);
+		(*m_dataAcquisition)->discardArmedBlock();
 	} else {
 		scanData.m_running = false;
 		scanTimer->stop();
+		(*m_dataAcquisition)->setConsumerActive(DAQ_CONSUMER::SCAN, false);
+		stopCalibration(true);
 		emit s_scanRunning(scanData.m_running);
 	}
 }
@@ -185,38 +276,100 @@ LOCK_SETTINGS Locking::getLockSettings() {
 	return lockSettings;
 }
 
-void Locking::lock() {
-	std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> values = (*m_dataAcquisition)->collectBlockData();
+// If the reference is acquired, the phase of the error signal is set relative to the measured reference
+// and the synthesised reference starts at zero phase. The modulation frequency is tracked on the first segment
+// of the measured reference. The tables are only recalculated if the estimate moves by more than the tolerance
+// or the acquisition parameters change.
+// Without the reference the acquisition is triggered and the synthesised reference starts at the calibrated
+// phase, the last tracked frequency is kept.
+void Locking::updateReference(const DAQ_BLOCK& block) {
+	double frequency = lockSettings.frequency;
+	double phase = 0;
+	gsl::span<const int32_t> reference = block.channels[1];
+	if (m_referenceFree) {
+		if (lockSettings.trackFrequency && !std::isnan(lockData.modulation.frequency)) {
+			frequency = lockData.modulation.frequency;
+		}
+		phase = lockSettings.referencePhase;
+	} else if (lockSettings.trackFrequency || m_calibrating) {
+		lockData.modulation = m_frequencyTracker.update(reference.first(std::min<size_t>(block.info.no_of_samples, reference.size())),
+			lockSettings.frequency, block.info.samplingRate);
+		double tolerance = lockSettings.frequencyTolerance * block.info.samplingRate / block.info.no_of_samples;
+		double current = m_referenceTable.getParameters().frequency;
+		if (lockSettings.trackFrequency && !std::isnan(lockData.modulation.frequency)) {
+			frequency = (abs(lockData.modulation.frequency - current) > tolerance) ? lockData.modulation.frequency : current;
+		}
+	}
+	// a partial period leaks into the error signal, unless the reference is windowed
+	double periods = block.info.no_of_samples * frequency / block.info.samplingRate;
+	bool windowed = abs(periods - round(periods)) > lockSettings.periodTolerance;
+	m_referenceTable.update({ frequency, phase, block.info.samplingRate, block.info.no_of_samples, windowed });
+}
 
-	std::chrono::time_point<std::chrono::system_clock> now = std::chrono::system_clock::now();
+// A single segment with an integer number of modulation periods, in which a quarter period is a whole number
+// of samples, is demodulated with the measured reference shifted by whole samples. This only reads the two
+// channels instead of the channels and both tables. Segmented blocks, windowed references and the
+// reference-free mode need the synthesised reference of the table.
+PDH_RESULT Locking::demodulate(const DAQ_BLOCK& block) {
+	if (m_referenceFree) {
+		return pdh.demodulate(block.channels[0], m_referenceTable, lockSettings.referenceAmplitude);
+	}
+	const REFERENCE_PARAMETERS& reference = m_referenceTable.getParameters();
+	double quarterPeriod = reference.samplingRate / (4 * reference.frequency);
+	if (block.no_of_segments == 1 && !reference.windowed && quarterPeriod >= 1 &&
+		abs(quarterPeriod - round(quarterPeriod)) / (4 * quarterPeriod) <= LOCKING_SHIFT_TOLERANCE) {
+		return pdh.demodulate(block.channels[0], block.channels[1], 0, (gsl::index)round(quarterPeriod));
+	}
+	return pdh.demodulate(block.channels[0], block.channels[1], m_referenceTable);
+}
 
-	std::vector<double> tau(values[0].begin(), values[0].end());
-	std::vector<double> reference(values[1].begin(), values[1].end());
+// An integer number of modulation periods per block does not need a window, which would reduce
+// the effective length of the block. If the device rejects every plan, the configured acquisition is kept
+// and the reference is windowed.
+void Locking::planAcquisition() {
+	if (!lockSettings.integerPeriods) {
+		return;
+	}
+	ACQUISITION_PLAN plan = (*m_dataAcquisition)->planAcquisition(lockSettings.frequency, lockSettings.periodTolerance);
+	if (plan.timebaseIndex < 0) {
+		emit(acquisitionPlanRejected());
+	}
+}
+
+void Locking::lock() {
+	// the newest block, which might have been acquired for the live view already
+	const DAQ_BLOCK* block = (*m_dataAcquisition)->acquireBlock(DAQ_CONSUMER::LOCKING);
+	if (!block) {
+		return;
+	}
 
-	//double tau_mean = generalmath::mean(tau);
-	double tau_max = generalmath::maximum(tau);
-	double tau_min = generalmath::minimum(tau);
-	double amplitude = tau_max - tau_min;
+	std::chrono::time_point<std::chrono::system_clock> now = std::chrono::system_clock::now();
 
-	if (amplitude != 0) {
-		for (int kk(0); kk < tau.size(); kk++) {
-			tau[kk] = (tau[kk] - tau_min) / amplitude;
+	// a clipped detector or reference signal gives a wrong error signal, so it must not reach the controller
+	if (block->info.overflow & 0b11) {
+		(*m_dataAcquisition)->releaseBlock(DAQ_CONSUMER::LOCKING);
+		if (lockData.clippedSince == std::chrono::time_point<std::chrono::system_clock>{}) {
+			lockData.clippedSince = now;
 		}
+		lockData.clippedBlocks++;
+		// abort locking, if the signals stay clipped for longer than the amplitude timeout
+		if (lockSettings.state == LOCKSTATE::ACTIVE &&
+			std::chrono::duration_cast<std::chrono::milliseconds>(now - lockData.clippedSince).count() / 1e3 > lockSettings.amplitudeTimeout) {
+			Locking::disableLocking(LOCKSTATE::FAILURE);
+		}
+		emit(clipped());
+		return;
 	}
+	lockData.clippedSince = {};
 
+	// demodulate the normalized transmission signal and the reference in a single pass,
+	// for segmented captures the block contains all segments, so the error is averaged over them
+	updateReference(*block);
+	PDH_RESULT result = demodulate(*block);
+	(*m_dataAcquisition)->releaseBlock(DAQ_CONSUMER::LOCKING);
 	// adjust for requested phase
-	ACQUISITION_PARAMETERS acquisitionParameters = (*m_dataAcquisition)->getAcquisitionParameters();
-	double samplingRate = (*m_dataAcquisition)->getCurrentSamplingRate();
-	int phaseStep = (int)lockSettings.phase * samplingRate / (360 * lockSettings.frequency);
-	if (phaseStep > 0) {
-		// simple rotation to the left
-		std::rotate(reference.begin(), reference.begin() + phaseStep, reference.end());
-	} else if (phaseStep < 0) {
-		// simple rotation to the right
-		std::rotate(reference.rbegin(), reference.rbegin() + phaseStep, reference.rend());
-	}
-
-	double error = pdh.getError(tau, reference);
+	double error = result.error(lockSettings.phase);
+	double amplitude = result.amplitude();
 
 
 	if (lockSettings.state == LOCKSTATE::ACTIVE) {
@@ -244,11 +397,11 @@ void Locking::lock() {
 				m_compensationTimer = 0;
 				if (m_daqVoltage > 0) {
 					(*m_piezoControl)->incrementVoltage(1);
-					m_piezoVoltage = (*m_piezoControl)->getVoltage();
 				} else {
 					(*m_piezoControl)->incrementVoltage(-1);
-					m_piezoVoltage = (*m_piezoControl)->getVoltage();
 				}
+				m_piezoVoltage = (*m_piezoControl)->getVoltage();
+				(*m_dataAcquisition)->discardArmedBlock();
 			}
 		} else {
 			lockSettings.compensating = false;
@@ -257,22 +410,31 @@ void Locking::lock() {
 
 		// abort locking if
 		// - output voltage is over 2 V
-		// - maximum of the signal amplitude in the last 50 measurements is below 0.05 V
-		if ((abs(m_daqVoltage) > 2)) {
-		//if ((abs(m_daqVoltage) > 2) || (generalmath::floatingMax(lockData.amplitude, 50) / static_cast<double>(1000) < 0.05)) {
+		// - maximum of the signal amplitude within the amplitude timeout is below the minimum amplitude
+		bool signalLost = lockData.amplitudeExtrema.size() >= lockData.amplitudeExtrema.getWindow() &&
+			std::max<double>(lockData.amplitudeExtrema.max(), amplitude) / static_cast<double>(1000) < lockSettings.minAmplitude;
+		if ((abs(m_daqVoltage) > 2) || signalLost) {
 			Locking::disableLocking(LOCKSTATE::FAILURE);
 		}
 
-		// set output voltage of the DAQ
+		// set output voltage of the DAQ, a block captured before must not be used for the control
 		(*m_dataAcquisition)->setOutputVoltage(m_daqVoltage);
+		(*m_dataAcquisition)->discardArmedBlock();
 	}
 
 	// write data to struct for storage
 	lockData.amplitude[lockData.nextIndex] = amplitude;
 	lockData.time[lockData.nextIndex] = now;
 	lockData.error[lockData.nextIndex] = error;
+	lockData.inPhase[lockData.nextIndex] = result.inPhase;
+	lockData.quadrature[lockData.nextIndex] = result.quadrature;
 	lockData.voltageDaq[lockData.nextIndex] = m_daqVoltage;
 	lockData.voltagePiezo[lockData.nextIndex] = m_piezoVoltage;
+	lockData.count = std::min(lockData.count + 1, (size_t)lockData.storageSize);
+	for (auto& statistics : lockData.errorStatistics) {
+		statistics.update(lockData.error, lockData.nextIndex, lockData.count);
+	}
+	lockData.amplitudeExtrema.update(lockData.amplitude, lockData.nextIndex);
 	lockData.nextIndex++;
 
 	// If the next index to write to is outside of the array, we wrap around to the start
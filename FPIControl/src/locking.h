@@ -8,11 +8,16 @@
 #include <array>
 #include <chrono>
 #include <ctime>
+#include <complex>
 
 #include "Devices\daq.h"
 #include "PDH.h"
 #include "Devices\kcubepiezo.h"
 #include "generalmath.h"
+#include "rollingStatistics.h"
+#include "frequencyTracker.h"
+
+#define LOCKING_SHIFT_TOLERANCE	1e-3	// [periods]	phase error of the quadrature, up to which the reference is shifted by whole samples
 
 typedef struct SCAN_SETTINGS {
 	double low{ 0 };			// [K] offset start
@@ -29,6 +34,7 @@ typedef struct SCAN_DATA {
 	std::vector<double> voltages;	// [microV] output voltage (<int32_t> is sufficient for this)
 	std::vector<int32_t> intensity;	// [microV] measured intensity (<int32_t> is fine)
 	std::vector<double> error;		// PDH error signal
+	std::vector<double> quadrature;	// quadrature component of the PDH error signal
 } SCAN_DATA;
 
 typedef enum enLockState {
@@ -37,19 +43,38 @@ typedef enum enLockState {
 	FAILURE
 } LOCKSTATE;
 
+// Windows of the rolling statistics of the error signal
+typedef enum class StatisticsWindow {
+	SHORT = 0,
+	MEDIUM = 1,
+	LONG = 2,
+	COUNT
+} STATISTICS_WINDOW;
+
 typedef struct LOCK_SETTINGS {
 	double proportional{ 2 };		//		control parameter of the proportional part
 	double integral{ 1 };			//		control parameter of the integral part
 	double derivative{ 0 };			//		control parameter of the derivative part
 	double frequency{ 5000 };		// [Hz] approx. frequency of the reference signal
 	double phase{ 180 };			// [degree]	phase shift between reference and detector signal
+	bool trackFrequency{ true };	//		follow the modulation frequency measured on the reference signal?
+	double frequencyTolerance{ 0.05 };	// [1]	change of the tracked frequency relative to the resolution of a block before the reference is recalculated
+	bool integerPeriods{ true };	//		choose the sampling rate and number of samples for an integer number of modulation periods per block?
+	double periodTolerance{ 0.01 };	// [1]	deviation from an integer number of periods, above which the reference is windowed
+	bool referenceFree{ false };	//		demodulate without acquiring the reference signal, which has to trigger the acquisition?
+	double referencePhase{ NAN };	// [degree]	phase of the reference signal at the trigger, calibrated by a scan
+	double referenceAmplitude{ NAN };	// [mV]	amplitude of the reference signal, calibrated by a scan
 	int lockingTimeout{ 100 };		// [ms]	time until next locking run
+	bool pipelined{ false };		//		capture the next block while the current one is processed? adds a locking run of delay
 	bool compensate{ true };		//		compensate the offset?
 	int compensationTimeout{ 25 };	//		cycles until next compensation
 	bool compensating{ false };		//		is it currently compensating?
 	double maxOffset{ 0.4 };		// [V]	maximum voltage of the external input before the offset compensation kicks in
 	double targetOffset{ 0.1 };		// [V]	target voltage of the offset compensation
+	double minAmplitude{ 0.05 };	// [V]	locking fails if the amplitude stays below this value for amplitudeTimeout
+	double amplitudeTimeout{ 5 };	// [s]	time without signal until locking fails
 	LOCKSTATE state{ LOCKSTATE::INACTIVE };	//		locking enabled?
+	std::array<double, (int)STATISTICS_WINDOW::COUNT> statisticsWindows{ 5, 60, 3600 };	// [s]	durations of the rolling statistics of the error signal
 } LOCK_SETTINGS;
 
 typedef struct LOCK_DATA {
@@ -57,12 +82,20 @@ typedef struct LOCK_DATA {
 	std::vector<double> voltageDaq;	// [V]	output voltage
 	std::vector<int32_t> amplitude;		// [microV]	measured intensity (<int32_t> is fine)
 	std::vector<double> error;			// [1]	PDH error signal
+	std::vector<double> inPhase;		// [1]	in-phase component of the PDH error signal
+	std::vector<double> quadrature;		// [1]	quadrature component of the PDH error signal
 	std::vector<double> voltagePiezo;	// [V]	output voltage
 	double iError{ 0 };					// [1]	integral value of the error signal
 	int storageDuration{ 4 * 3600 };	// [s]	maximum time to store data for (after this time, data from the start will be overwritten)
 	int storageSize;					//		size of the storage array (depends on storageDuration and lockSettings.lockingTimeout)
 	gsl::index nextIndex{ 0 };			//		the index to write to next
+	size_t count{ 0 };					//		number of stored values
+	std::array<RollingStatistics, (int)STATISTICS_WINDOW::COUNT> errorStatistics;	// mean and standard deviation of the error signal
+	SlidingExtrema<int32_t> amplitudeExtrema;	//		extrema of the amplitude within lockSettings.amplitudeTimeout
+	FREQUENCY_ESTIMATE modulation;		//		frequency, phase and amplitude of the modulation on the reference signal
 	std::chrono::time_point<std::chrono::system_clock> startTime;
+	size_t clippedBlocks{ 0 };			//		number of blocks rejected, because a channel was clipped
+	std::chrono::time_point<std::chrono::system_clock> clippedSince;	// time of the first of the currently rejected blocks
 } LOCK_DATA;
 
 enum class liveViewPlotTypes {
@@ -110,6 +143,7 @@ class Locking : public QObject {
 		void setLockState(LOCKSTATE lockstate = LOCKSTATE::INACTIVE);
 		void setScanParameters(SCANPARAMETERS type, double value);
 		void setLockParameters(LOCKPARAMETERS type, double value);
+		void setStatisticsWindow(STATISTICS_WINDOW window, double duration);
 		SCAN_SETTINGS getScanSettings();
 		SCAN_DATA scanData;
 		LOCK_SETTINGS getLockSettings();
@@ -123,6 +157,8 @@ class Locking : public QObject {
 		void startStopLocking();
 
 		void toggleOffsetCompensation(bool);
+		void toggleReferenceFree(bool);
+		void togglePipelining(bool);
 
 	private:
 		kcubepiezo** m_piezoControl;
@@ -135,12 +171,23 @@ class Locking : public QObject {
 		QElapsedTimer passTimer;
 		SCAN_SETTINGS scanSettings;
 		LOCK_SETTINGS lockSettings;
+		ReferenceTable m_referenceTable;		// synthesised reference for the demodulation
+		FrequencyTracker m_frequencyTracker;	// modulation frequency measured on the reference
+		bool m_referenceFree{ false };			// is the reference channel disabled for locking?
+		bool m_calibrating{ false };			// is the reference calibrated by the running scan?
+		std::complex<double> m_referencePhasor{ 0 };	// [mV] sum of the phasors of the reference at the trigger
+		int m_referencePhasorCount{ 0 };
 
 		double m_daqVoltage{ 0 };
 		double m_piezoVoltage{ 0 };
 		int m_compensationTimer{ 0 };
 		
 		void disableLocking(LOCKSTATE lockstate);
+		void updateReference(const DAQ_BLOCK& block);
+		PDH_RESULT demodulate(const DAQ_BLOCK& block);
+		void planAcquisition();
+		void setReferenceFree(bool referenceFree);
+		void stopCalibration(bool completed);
 
 	private slots:
 		void lock();
@@ -151,6 +198,8 @@ class Locking : public QObject {
 		void s_scanPassAcquired();
 		void s_acquireLockingRunning(bool);
 		void locked();
+		void clipped();
+		void acquisitionPlanRejected();
 		void lockStateChanged(LOCKSTATE);
 		void compensationStateChanged(bool);
 };
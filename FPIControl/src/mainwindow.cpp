@@ -80,6 +80,20 @@ MainWindow::MainWindow(QWidget* parent) noexcept :
 		[this]() { updateLockView(); }
 	);
 
+	connection = QWidget::connect(
+		m_lockingControl,
+		&Locking::clipped,
+		this,
+		&MainWindow::updateClippedBlocks
+	);
+
+	connection = QWidget::connect(
+		m_lockingControl,
+		&Locking::acquisitionPlanRejected,
+		this,
+		&MainWindow::updateAcquisitionPlanRejected
+	);
+
 	connection = QWidget::connect(
 		m_lockingControl,
 		&Locking::lockStateChanged,
@@ -313,10 +327,16 @@ void MainWindow::initDAQ() {
 	case PS_TYPES::MODEL_PS2000A:
 		m_dataAcquisition = new daq_PS2000A(nullptr);
 		break;
+	case PS_TYPES::MODEL_SIMULATED:
+		m_dataAcquisition = new daq_Simulated(nullptr);
+		break;
 	default:
 		m_dataAcquisition = new daq_PS2000(nullptr);
 		break;
 	}
+	m_dataAcquisition->setAcquisitionMode(m_daqStreaming ? ACQUISITION_MODE::STREAMING : ACQUISITION_MODE::BLOCK);
+	m_dataAcquisition->setNumberSegments(m_daqSegments);
+	m_dataAcquisition->setDownsampling(m_liveViewDownsampling, m_liveViewAggregate ? DOWNSAMPLING_MODE::AGGREGATE : DOWNSAMPLING_MODE::AVERAGE);
 
 	m_acquisitionThread.startWorker(m_dataAcquisition);
 
@@ -411,12 +431,20 @@ void MainWindow::on_actionAbout_triggered() {
 
 void MainWindow::on_actionSettings_triggered() {
 	m_daqDropdown->setCurrentIndex((int)m_daqType);
+	m_daqStreamingCheckBox->setChecked(m_daqStreaming);
+	m_daqSegmentsInput->setValue(m_daqSegments);
+	m_liveViewDownsamplingInput->setValue(m_liveViewDownsampling);
+	m_liveViewAggregateCheckBox->setChecked(m_liveViewAggregate);
 	m_piezoSerialInput->setText(QString::fromStdString(m_serialNo));
 	settingsDialog->show();
 }
 
 void MainWindow::saveSettings() {
 	m_daqType = m_daqTypeTemporary;
+	m_daqStreaming = m_daqStreamingCheckBox->isChecked();
+	m_daqSegments = m_daqSegmentsInput->value();
+	m_liveViewDownsampling = m_liveViewDownsamplingInput->value();
+	m_liveViewAggregate = m_liveViewAggregateCheckBox->isChecked();
 	m_serialNo = m_piezoSerialInput->text().toStdString();
 	settingsDialog->hide();
 	writeSettings();
@@ -469,6 +497,35 @@ void MainWindow::initSettingsDialog() {
 		&MainWindow::selectDAQ
 	);
 
+	m_daqStreamingCheckBox = new QCheckBox("Streaming");
+	m_daqStreamingCheckBox->setToolTip("Acquire continuously instead of arming the device for every block");
+	layout->addWidget(m_daqStreamingCheckBox);
+
+	QLabel* segmentsLabel = new QLabel("Segments");
+	layout->addWidget(segmentsLabel);
+
+	m_daqSegmentsInput = new QSpinBox();
+	m_daqSegmentsInput->setRange(1, 64);
+	m_daqSegmentsInput->setToolTip("Number of blocks captured at once and averaged for the error signal");
+	layout->addWidget(m_daqSegmentsInput);
+
+	// the device captures fewer segments, if they do not fit into its memory
+	m_daqSegmentsApplied = new QLabel();
+	m_daqSegmentsApplied->setToolTip("Number of segments used by the device");
+	layout->addWidget(m_daqSegmentsApplied);
+
+	QLabel* downsamplingLabel = new QLabel("Live view ratio");
+	layout->addWidget(downsamplingLabel);
+
+	m_liveViewDownsamplingInput = new QSpinBox();
+	m_liveViewDownsamplingInput->setRange(1, 1000);
+	m_liveViewDownsamplingInput->setToolTip("Number of samples combined into one point of the live view");
+	layout->addWidget(m_liveViewDownsamplingInput);
+
+	m_liveViewAggregateCheckBox = new QCheckBox("Min/max");
+	m_liveViewAggregateCheckBox->setToolTip("Show the minimum and maximum of the combined samples instead of their average");
+	layout->addWidget(m_liveViewAggregateCheckBox);
+
 	QWidget* piezoWidget = new QWidget();
 	piezoWidget->setMinimumHeight(100);
 	piezoWidget->setMinimumWidth(400);
@@ -727,14 +784,29 @@ void MainWindow::on_setVoltage_valueChanged(const double voltage) {
 void MainWindow::updateLiveView() {
 	if (m_selectedView == VIEWS::LIVE) {
 
-		m_dataAcquisition->m_liveBuffer->m_usedBuffers->acquire();
-		int16_t **buffer = m_dataAcquisition->m_liveBuffer->getReadBuffer();
+		// newest block, older ones are skipped if the GUI is too slow
+		int16_t **buffer = m_dataAcquisition->m_liveBuffer.getReadBuffer();
+		if (!buffer) {
+			return;
+		}
 
+		// the points are downsampled by the DAQ, plot them at the original sample index,
+		// aggregated points are drawn as an envelope alternating between the maximum and the minimum
+		gsl::index length = std::min(1000, m_liveViewLength);
 		std::array<QVector<QPointF>, PS2000_MAX_CHANNELS> data;
 		for (gsl::index channel{ 0 }; channel < 4; channel++) {
-			data[channel].resize(1000);
-			for (gsl::index jj{ 0 }; jj < 1000; jj++) {
-				data[channel][jj] = QPointF(jj, buffer[channel][jj] / static_cast<double>(1e3));
+			if (channel >= (gsl::index)m_liveViewChannels.size() || !m_liveViewChannels[channel]) {
+				continue;
+			}
+			int16_t* minima = buffer[DAQ_MAX_CHANNELS + channel];
+			data[channel].resize(m_liveViewEnvelope ? 2 * length : length);
+			for (gsl::index jj{ 0 }; jj < length; jj++) {
+				if (m_liveViewEnvelope) {
+					data[channel][2 * jj] = QPointF(jj * m_liveViewRatio, buffer[channel][jj] / static_cast<double>(1e3));
+					data[channel][2 * jj + 1] = QPointF((jj + 0.5) * m_liveViewRatio, minima[jj] / static_cast<double>(1e3));
+				} else {
+					data[channel][jj] = QPointF(jj * m_liveViewRatio, buffer[channel][jj] / static_cast<double>(1e3));
+				}
 			}
 		}
 
@@ -745,9 +817,7 @@ void MainWindow::updateLiveView() {
 			}
 			++channel;
 		}
-		liveViewChart->axisX()->setRange(0, data[0].length());
-
-		m_dataAcquisition->m_liveBuffer->m_freeBuffers->release();
+		liveViewChart->axisX()->setRange(0, length * m_liveViewRatio);
 	}
 }
 
@@ -773,12 +843,12 @@ void MainWindow::updateLockView() {
 			QPointF(passed, m_lockingControl->lockData.voltagePiezo[prevIndex])
 		);
 
-		auto offset = m_lockingControl->lockData.storageSize - m_lockingControl->lockData.nextIndex;
+		const RollingStatistics& statistics = m_lockingControl->lockData.errorStatistics[(int)STATISTICS_WINDOW::SHORT];
 		lockViewPlots[static_cast<int>(lockViewPlotTypes::ERRORSIGNALMEAN)]->append(
-			QPointF(passed, generalmath::floatingMean(m_lockingControl->lockData.error, 50, offset) / 100.0)
+			QPointF(passed, statistics.mean() / 100.0)
 		);
 		lockViewPlots[static_cast<int>(lockViewPlotTypes::ERRORSIGNALSTD)]->append(
-			QPointF(passed, generalmath::floatingStandardDeviation(m_lockingControl->lockData.error, 50, offset) / 100.0)
+			QPointF(passed, statistics.standardDeviation() / 100.0)
 		);
 
 		// If there are more points than desired, remove the first one
@@ -801,6 +871,17 @@ void MainWindow::updateLockView() {
 	}
 }
 
+// blocks with a clipped channel are not used for locking
+void MainWindow::updateClippedBlocks() {
+	lockViewChart->setTitle(QString("Lock View (%1 clipped blocks rejected)").arg(m_lockingControl->lockData.clippedBlocks));
+	statusInfo->setText("Input signal clipped, please check the input range.");
+}
+
+// the device did not accept any sampling rate with an integer number of modulation periods per block
+void MainWindow::updateAcquisitionPlanRejected() {
+	statusInfo->setText("No sampling rate for an integer number of periods was accepted, the configured acquisition is used.");
+}
+
 void MainWindow::updateScanView() {
 	if (m_selectedView == VIEWS::SCAN) {
 		SCAN_DATA scanData = m_lockingControl->scanData;
@@ -828,6 +909,18 @@ void MainWindow::updateAcquisitionParameters(ACQUISITION_PARAMETERS acquisitionP
 	ui->sampleRate->setCurrentIndex(acquisitionParameters.timebaseIndex);
 	// set number of samples
 	ui->sampleNumber->setValue(acquisitionParameters.no_of_samples);
+	// number of points in the live view
+	m_liveViewRatio = (acquisitionParameters.downsampling_mode == DOWNSAMPLING_MODE::NONE) ? 1 : acquisitionParameters.downsampling_ratio;
+	m_liveViewLength = acquisitionParameters.no_of_samples / m_liveViewRatio;
+	m_liveViewEnvelope = (m_liveViewRatio > 1 && acquisitionParameters.downsampling_mode == DOWNSAMPLING_MODE::AGGREGATE);
+	for (gsl::index ch{ 0 }; ch < (gsl::index)m_liveViewChannels.size(); ch++) {
+		m_liveViewChannels[ch] = acquisitionParameters.channelSettings[ch].enabled;
+	}
+	// number of segments, which fit into the memory of the device
+	if (m_daqSegmentsApplied) {
+		m_daqSegmentsApplied->setText(((int)acquisitionParameters.no_of_segments != m_daqSegments) ?
+			QString("(%1 used)").arg(acquisitionParameters.no_of_segments) : QString());
+	}
 	// set range
 	ui->chARange->setCurrentIndex(acquisitionParameters.channelSettings[0].range - 2);
 	ui->chBRange->setCurrentIndex(acquisitionParameters.channelSettings[1].range - 2);
@@ -939,6 +1032,8 @@ void MainWindow::daqConnectionChanged(bool connected) {
 	m_isDAQConnected = connected;
 	if (connected) {
 		statusInfo->setText("Successfully connected to data acquisition card.");
+		// the sampling rates depend on the connected model
+		updateSamplingRates();
 	} else {
 		statusInfo->setText("Successfully disconnected from data acquisition card.");
 	}
@@ -1007,6 +1102,9 @@ void MainWindow::writeSettings() {
 	case PS_TYPES::MODEL_PS2000A:
 		daq = "PS2000A";
 		break;
+	case PS_TYPES::MODEL_SIMULATED:
+		daq = "Simulated";
+		break;
 	default:
 		daq = "PS2000A";
 		break;
@@ -1014,6 +1112,10 @@ void MainWindow::writeSettings() {
 
 	settings.beginGroup("devices");
 	settings.setValue("daq", daq);
+	settings.setValue("daq-streaming", m_daqStreaming);
+	settings.setValue("daq-segments", m_daqSegments);
+	settings.setValue("live-view-downsampling", m_liveViewDownsampling);
+	settings.setValue("live-view-aggregate", m_liveViewAggregate);
 	settings.setValue("kcube-piezo-serial", QString::fromStdString(m_serialNo));
 	settings.endGroup();
 }
@@ -1031,8 +1133,14 @@ void MainWindow::readSettings() {
 		m_daqType = PS_TYPES::MODEL_PS2000;
 	} else if (daq == "PS2000A") {
 		m_daqType = PS_TYPES::MODEL_PS2000A;
+	} else if (daq == "Simulated") {
+		m_daqType = PS_TYPES::MODEL_SIMULATED;
 	} else {
 		m_daqType = PS_TYPES::MODEL_PS2000A;
 	}
+	m_daqStreaming = settings.value("daq-streaming", false).toBool();
+	m_daqSegments = settings.value("daq-segments", 1).toInt();
+	m_liveViewDownsampling = settings.value("live-view-downsampling", 1).toInt();
+	m_liveViewAggregate = settings.value("live-view-aggregate", false).toBool();
 	settings.endGroup();
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 
 #include "Devices\DAQ_PS2000.h"
 #include "Devices\DAQ_PS2000A.h"
+#include "Devices\DAQ_Simulated.h"
 #include "locking.h"
 #include "Devices\kcubepiezo.h"
 #include "thread.h"
@@ -105,6 +106,19 @@ private:
 	PS_TYPES m_daqType{ PS_TYPES::MODEL_PS2000A };
 	PS_TYPES m_daqTypeTemporary = m_daqType;
 	QComboBox* m_daqDropdown{ nullptr };
+	bool m_daqStreaming{ false };
+	QCheckBox* m_daqStreamingCheckBox{ nullptr };
+	int m_daqSegments{ 1 };
+	QSpinBox* m_daqSegmentsInput{ nullptr };
+	QLabel* m_daqSegmentsApplied{ nullptr };
+	int m_liveViewDownsampling{ 1 };
+	QSpinBox* m_liveViewDownsamplingInput{ nullptr };
+	bool m_liveViewAggregate{ false };
+	QCheckBox* m_liveViewAggregateCheckBox{ nullptr };
+	int m_liveViewRatio{ 1 };		// downsampling ratio applied by the DAQ
+	bool m_liveViewEnvelope{ false };	// the DAQ provides the minimum and maximum of every point
+	int m_liveViewLength{ 1000 };	// number of points in a live view block
+	std::array<bool, 2> m_liveViewChannels{ true, true };	// channels acquired by the DAQ, disabled ones are not plotted
 	QLineEdit* m_piezoSerialInput{ nullptr };
 
 	QDialog* settingsDialog{ nullptr };
@@ -178,6 +192,8 @@ private slots:
 	void updateLiveView();
 	void updateScanView();
 	void updateLockView();
+	void updateClippedBlocks();
+	void updateAcquisitionPlanRejected();
 
 	// SLOTS for updating the acquisition parameters
 	void updateAcquisitionParameters(ACQUISITION_PARAMETERS acquisitionParameters);
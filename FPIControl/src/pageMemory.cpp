@@ -0,0 +1,51 @@
+#include "pageMemory.h"
+#include <new>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+void* pageMemory::allocate(std::size_t size) {
+	void* memory{ nullptr };
+#ifdef _WIN32
+	// large pages need the "Lock pages in memory" privilege, use normal pages otherwise
+	std::size_t largePage = GetLargePageMinimum();
+	if (largePage > 0 && size >= largePage) {
+		std::size_t largeSize = ((size + largePage - 1) / largePage) * largePage;
+		memory = VirtualAlloc(nullptr, largeSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+	}
+	if (!memory) {
+		memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	}
+#else
+	memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) {
+		memory = nullptr;
+	}
+#ifdef MADV_HUGEPAGE
+	else {
+		madvise(memory, size, MADV_HUGEPAGE);
+	}
+#endif
+#endif
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void pageMemory::release(void* memory, std::size_t size) {
+	if (!memory) {
+		return;
+	}
+#ifdef _WIN32
+	VirtualFree(memory, 0, MEM_RELEASE);
+#else
+	munmap(memory, size);
+#endif
+}
\ No newline at end of file
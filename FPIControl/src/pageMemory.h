@@ -0,0 +1,15 @@
+#ifndef PAGEMEMORY_H
+#define PAGEMEMORY_H
+
+#include <cstddef>
+
+// Memory mapped directly from the operating system instead of the heap.
+// Large pages are used if the process is allowed to, so that large buffers
+// need fewer TLB entries. The memory is at least aligned to a page.
+class pageMemory {
+public:
+	static void* allocate(std::size_t size);
+	static void release(void* memory, std::size_t size);
+};
+
+#endif // PAGEMEMORY_H
\ No newline at end of file
@@ -0,0 +1,182 @@
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <gsl/gsl>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REDUCTION_SSE2
+#include <emmintrin.h>
+#endif
+
+// Statistics of a buffer, which are calculated in a single pass
+typedef struct REDUCE_STATS {
+	double min{ NAN };			// NaN if the buffer is empty
+	double max{ NAN };
+	double sum{ 0 };
+	double absSum{ 0 };			// sum of the absolute values
+	double sumSquares{ 0 };
+	std::size_t count{ 0 };
+	double mean() const { return sum / count; };
+	double amplitude() const { return max - min; };
+} REDUCE_STATS;
+
+// Fused reduction of whole channel buffers, so that every sample is read only once.
+// The samples are converted to double precision, in which the sums of integer samples are
+// exact for any realistic buffer size. The instruction set is chosen at compile time like
+// in the conversion: AVX2 if enabled (/arch:AVX2), SSE2 on every x64 build and a scalar loop otherwise.
+class reduction {
+public:
+	static REDUCE_STATS reduceStats(gsl::span<const int16_t> values) {
+		return reduce(values);
+	}
+
+	static REDUCE_STATS reduceStats(gsl::span<const int32_t> values) {
+		return reduce(values);
+	}
+
+	static REDUCE_STATS reduceStats(gsl::span<const float> values) {
+		return reduce(values);
+	}
+
+	// vector loads converting to double precision, which are shared with other kernels
+#if defined(__AVX2__)
+	// load eight values as two vectors of four doubles
+	static void load(const int16_t* values, __m256d& low, __m256d& high) {
+		__m256i integers = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values)));
+		low = _mm256_cvtepi32_pd(_mm256_castsi256_si128(integers));
+		high = _mm256_cvtepi32_pd(_mm256_extracti128_si256(integers, 1));
+	}
+
+	static void load(const int32_t* values, __m256d& low, __m256d& high) {
+		__m256i integers = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+		low = _mm256_cvtepi32_pd(_mm256_castsi256_si128(integers));
+		high = _mm256_cvtepi32_pd(_mm256_extracti128_si256(integers, 1));
+	}
+
+	static void load(const float* values, __m256d& low, __m256d& high) {
+		__m256 floats = _mm256_loadu_ps(values);
+		low = _mm256_cvtps_pd(_mm256_castps256_ps128(floats));
+		high = _mm256_cvtps_pd(_mm256_extractf128_ps(floats, 1));
+	}
+#elif defined(REDUCTION_SSE2)
+	// load four values as two vectors of two doubles
+	static void load(const int16_t* values, __m128d& low, __m128d& high) {
+		__m128i integers = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values));
+		// sign extend to 32 bit
+		integers = _mm_srai_epi32(_mm_unpacklo_epi16(integers, integers), 16);
+		low = _mm_cvtepi32_pd(integers);
+		high = _mm_cvtepi32_pd(_mm_shuffle_epi32(integers, _MM_SHUFFLE(1, 0, 3, 2)));
+	}
+
+	static void load(const int32_t* values, __m128d& low, __m128d& high) {
+		__m128i integers = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+		low = _mm_cvtepi32_pd(integers);
+		high = _mm_cvtepi32_pd(_mm_shuffle_epi32(integers, _MM_SHUFFLE(1, 0, 3, 2)));
+	}
+
+	static void load(const float* values, __m128d& low, __m128d& high) {
+		__m128 floats = _mm_loadu_ps(values);
+		low = _mm_cvtps_pd(floats);
+		high = _mm_cvtps_pd(_mm_movehl_ps(floats, floats));
+	}
+#endif
+
+private:
+	template<class T>
+	static REDUCE_STATS reduce(gsl::span<const T> values) {
+		const gsl::index length = values.size();
+		gsl::index i{ 0 };
+		REDUCE_STATS stats;
+		stats.min = std::numeric_limits<double>::infinity();
+		stats.max = -std::numeric_limits<double>::infinity();
+#if defined(__AVX2__)
+		__m256d min = _mm256_set1_pd(stats.min);
+		__m256d max = _mm256_set1_pd(stats.max);
+		__m256d sum = _mm256_setzero_pd();
+		__m256d absSum = _mm256_setzero_pd();
+		__m256d sumSquares = _mm256_setzero_pd();
+		const __m256d signMask = _mm256_set1_pd(-0.0);
+		auto accumulate = [&](__m256d value) {
+			min = _mm256_min_pd(min, value);
+			max = _mm256_max_pd(max, value);
+			sum = _mm256_add_pd(sum, value);
+			absSum = _mm256_add_pd(absSum, _mm256_andnot_pd(signMask, value));
+			sumSquares = _mm256_add_pd(sumSquares, _mm256_mul_pd(value, value));
+		};
+		for (; i + 8 <= length; i += 8) {
+			__m256d low, high;
+			load(&values[i], low, high);
+			accumulate(low);
+			accumulate(high);
+		}
+		alignas(32) double lanes[5][4];
+		_mm256_store_pd(lanes[0], min);
+		_mm256_store_pd(lanes[1], max);
+		_mm256_store_pd(lanes[2], sum);
+		_mm256_store_pd(lanes[3], absSum);
+		_mm256_store_pd(lanes[4], sumSquares);
+		combine(stats, lanes, 4);
+#elif defined(REDUCTION_SSE2)
+		__m128d min = _mm_set1_pd(stats.min);
+		__m128d max = _mm_set1_pd(stats.max);
+		__m128d sum = _mm_setzero_pd();
+		__m128d absSum = _mm_setzero_pd();
+		__m128d sumSquares = _mm_setzero_pd();
+		const __m128d signMask = _mm_set1_pd(-0.0);
+		auto accumulate = [&](__m128d value) {
+			min = _mm_min_pd(min, value);
+			max = _mm_max_pd(max, value);
+			sum = _mm_add_pd(sum, value);
+			absSum = _mm_add_pd(absSum, _mm_andnot_pd(signMask, value));
+			sumSquares = _mm_add_pd(sumSquares, _mm_mul_pd(value, value));
+		};
+		for (; i + 4 <= length; i += 4) {
+			__m128d low, high;
+			load(&values[i], low, high);
+			accumulate(low);
+			accumulate(high);
+		}
+		alignas(16) double lanes[5][4];
+		_mm_store_pd(lanes[0], min);
+		_mm_store_pd(lanes[1], max);
+		_mm_store_pd(lanes[2], sum);
+		_mm_store_pd(lanes[3], absSum);
+		_mm_store_pd(lanes[4], sumSquares);
+		combine(stats, lanes, 2);
+#endif
+		for (; i < length; i++) {
+			double value = values[i];
+			stats.min = std::min(stats.min, value);
+			stats.max = std::max(stats.max, value);
+			stats.sum += value;
+			stats.absSum += std::abs(value);
+			stats.sumSquares += value * value;
+		}
+		stats.count = values.size();
+		if (stats.count == 0) {
+			stats.min = NAN;
+			stats.max = NAN;
+		}
+		return stats;
+	}
+
+	// add the lanes of the vector accumulators to the statistics
+	static void combine(REDUCE_STATS& stats, const double lanes[5][4], int width) {
+		for (gsl::index lane{ 0 }; lane < width; lane++) {
+			stats.min = std::min(stats.min, lanes[0][lane]);
+			stats.max = std::max(stats.max, lanes[1][lane]);
+			stats.sum += lanes[2][lane];
+			stats.absSum += lanes[3][lane];
+			stats.sumSquares += lanes[4][lane];
+		}
+	}
+
+};
+
+#endif // REDUCTION_H
\ No newline at end of file
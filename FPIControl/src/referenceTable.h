@@ -0,0 +1,86 @@
+#ifndef REFERENCETABLE_H
+#define REFERENCETABLE_H
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <gsl/gsl>
+
+#define REFERENCETABLE_TWO_PI	6.283185307179586476925	// [rad]	one period
+
+// Parameters of the synthesised reference
+typedef struct REFERENCE_PARAMETERS {
+	double frequency{ 0 };			// [Hz]		modulation frequency
+	double phase{ 0 };				// [degree]	phase of the reference at the first sample
+	double samplingRate{ 0 };		// [Hz]
+	size_t no_of_samples{ 0 };		//			length of the tables
+	bool windowed{ false };			//			apply a Hann window, if the tables do not hold an integer number of periods
+	bool operator==(const REFERENCE_PARAMETERS& other) const {
+		return frequency == other.frequency && phase == other.phase &&
+			samplingRate == other.samplingRate && no_of_samples == other.no_of_samples && windowed == other.windowed;
+	};
+	bool operator!=(const REFERENCE_PARAMETERS& other) const { return !(*this == other); };
+} REFERENCE_PARAMETERS;
+
+// Sine and cosine of the modulation, sampled like the acquired signals. The tables are only
+// recalculated if a parameter changes, so that demodulating a block does not evaluate any
+// trigonometric function. The phase is not limited to whole samples.
+// The window is part of the tables, so it does not cost anything per block. It is scaled to a mean
+// of one, so that a windowed table demodulates a sinusoid to the same amplitude.
+class ReferenceTable {
+
+public:
+	ReferenceTable() noexcept {};
+
+	// returns true if the tables were recalculated
+	bool update(const REFERENCE_PARAMETERS& parameters) {
+		if (m_valid && parameters == m_parameters) {
+			return false;
+		}
+		m_parameters = parameters;
+		m_cosine.resize(parameters.no_of_samples);
+		m_sine.resize(parameters.no_of_samples);
+		double cyclesPerSample = (parameters.samplingRate > 0) ? parameters.frequency / parameters.samplingRate : 0;
+		double phase = parameters.phase / 360;
+		std::complex<double> sum{ 0 };
+		for (gsl::index i{ 0 }; i < (gsl::index)parameters.no_of_samples; i++) {
+			// keep the argument within one period, so that long tables do not lose precision
+			double cycles = cyclesPerSample * i + phase;
+			double angle = REFERENCETABLE_TWO_PI * (cycles - floor(cycles));
+			double window = parameters.windowed ? 1 - cos(REFERENCETABLE_TWO_PI * i / parameters.no_of_samples) : 1;
+			m_cosine[i] = (float)(window * cos(angle));
+			m_sine[i] = (float)(window * sin(angle));
+			sum += std::complex<double>(m_cosine[i], -m_sine[i]);
+		}
+		m_mean = (parameters.no_of_samples > 0) ? sum / (double)parameters.no_of_samples : 0;
+		m_valid = true;
+		return true;
+	};
+
+	const REFERENCE_PARAMETERS& getParameters() const noexcept { return m_parameters; };
+	size_t size() const noexcept { return m_cosine.size(); };
+
+	gsl::span<const float> cosine() const noexcept { return m_cosine; };
+	gsl::span<const float> sine() const noexcept { return m_sine; };
+
+	// mean of cos - i sin over the first count samples, cached for the whole table
+	std::complex<double> mean(size_t count) const {
+		if (count >= m_cosine.size()) {
+			return m_mean;
+		}
+		std::complex<double> sum{ 0 };
+		for (gsl::index i{ 0 }; i < (gsl::index)count; i++) {
+			sum += std::complex<double>(m_cosine[i], -m_sine[i]);
+		}
+		return (count > 0) ? sum / (double)count : 0;
+	};
+
+private:
+	REFERENCE_PARAMETERS m_parameters;
+	std::vector<float> m_cosine;
+	std::vector<float> m_sine;
+	std::complex<double> m_mean{ 0 };
+	bool m_valid{ false };
+};
+
+#endif // REFERENCETABLE_H
\ No newline at end of file
@@ -0,0 +1,178 @@
+#ifndef ROLLINGSTATISTICS_H
+#define ROLLINGSTATISTICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <gsl/gsl>
+#include "generalmath.h"
+
+// Mean and standard deviation over the newest values of a ring buffer, which are updated
+// in constant time per new value, independent of the window length. The values are not
+// copied, the value leaving the window is read from the ring. Several windows can be kept
+// over the same ring.
+class RollingStatistics {
+
+public:
+	explicit RollingStatistics(size_t window = 1) noexcept : m_window(std::max<size_t>(window, 1)) {};
+
+	// The value at history[index] was just written, count values of the ring are valid.
+	void update(gsl::span<const double> history, gsl::index index, size_t count) {
+		size_t window = std::min(m_window, history.size() - 1);
+		if (count > window) {
+			remove(history[generalmath::indexWrapped((int)index - (int)window, (int)history.size())]);
+		}
+		add(history[index]);
+	};
+
+	// Change the window length, the statistics are recalculated from the ring once.
+	void setWindow(size_t window, gsl::span<const double> history, gsl::index index, size_t count) {
+		m_window = std::max<size_t>(window, 1);
+		reset();
+		size_t length = std::min({ m_window, history.size() - 1, count });
+		for (gsl::index i{ (gsl::index)length - 1 }; i >= 0; i--) {
+			add(history[generalmath::indexWrapped((int)(index - i), (int)history.size())]);
+		}
+	};
+
+	void reset() noexcept {
+		m_count = 0;
+		m_mean = 0;
+		m_m2 = 0;
+	};
+
+	size_t getWindow() const noexcept { return m_window; };
+	size_t size() const noexcept { return m_count; };
+
+	double mean() const noexcept {
+		return (m_count > 0) ? m_mean : nan("1");
+	};
+
+	double variance() const noexcept {
+		return (m_count > 1) ? m_m2 / (m_count - 1) : nan("1");
+	};
+
+	double standardDeviation() const noexcept {
+		return sqrt(variance());
+	};
+
+private:
+	// Welford's algorithm, which does not lose precision like a running sum of squares
+	void add(double value) noexcept {
+		m_count++;
+		double delta = value - m_mean;
+		m_mean += delta / m_count;
+		m_m2 += delta * (value - m_mean);
+	};
+
+	void remove(double value) noexcept {
+		if (m_count <= 1) {
+			reset();
+			return;
+		}
+		m_count--;
+		double delta = value - m_mean;
+		m_mean -= delta / m_count;
+		// rounding errors must not make the variance negative
+		m_m2 = std::max(0.0, m_m2 - delta * (value - m_mean));
+	};
+
+	size_t m_window;			// maximum number of values
+	size_t m_count{ 0 };		// number of values in the window
+	double m_mean{ 0 };
+	double m_m2{ 0 };			// sum of the squared deviations from the mean
+};
+
+// Minimum and maximum over the newest values of a ring buffer in amortised constant time per
+// new value. Every extremum is kept in a monotonic queue together with its position, values
+// are dropped once they leave the window or a newer value supersedes them.
+template<class T> class SlidingExtrema {
+
+public:
+	explicit SlidingExtrema(size_t window = 1) { resize(window); };
+
+	// The value at history[index] was just written.
+	void update(gsl::span<const T> history, gsl::index index) {
+		add(history[index]);
+	};
+
+	// Change the window length, the extrema are recalculated from the ring once.
+	void setWindow(size_t window, gsl::span<const T> history, gsl::index index, size_t count) {
+		resize(window);
+		size_t length = std::min({ m_window, history.size(), count });
+		for (gsl::index i{ (gsl::index)length - 1 }; i >= 0; i--) {
+			add(history[generalmath::indexWrapped((int)(index - i), (int)history.size())]);
+		}
+	};
+
+	void reset() noexcept {
+		m_maxima.clear();
+		m_minima.clear();
+		m_position = 0;
+	};
+
+	size_t getWindow() const noexcept { return m_window; };
+	size_t size() const noexcept { return std::min<size_t>(m_position, m_window); };
+
+	// only valid if size() > 0
+	T max() const noexcept { return m_maxima.front().value; };
+	T min() const noexcept { return m_minima.front().value; };
+
+private:
+	typedef struct ENTRY {
+		uint64_t position{ 0 };
+		T value{ 0 };
+	} ENTRY;
+
+	// double ended queue in a fixed ring, which does not allocate after it was sized
+	class Queue {
+	public:
+		void resize(size_t capacity) { m_entries.resize(capacity); clear(); };
+		void clear() noexcept { m_first = 0; m_length = 0; };
+		bool empty() const noexcept { return m_length == 0; };
+		const ENTRY& front() const noexcept { return m_entries[m_first]; };
+		const ENTRY& back() const noexcept { return m_entries[(m_first + m_length - 1) % m_entries.size()]; };
+		void popFront() noexcept { m_first = (m_first + 1) % m_entries.size(); m_length--; };
+		void popBack() noexcept { m_length--; };
+		void pushBack(ENTRY entry) noexcept { m_entries[(m_first + m_length++) % m_entries.size()] = entry; };
+	private:
+		std::vector<ENTRY> m_entries;
+		size_t m_first{ 0 };
+		size_t m_length{ 0 };
+	};
+
+	void resize(size_t window) {
+		m_window = std::max<size_t>(window, 1);
+		m_maxima.resize(m_window);
+		m_minima.resize(m_window);
+		m_position = 0;
+	};
+
+	void add(T value) noexcept {
+		// values, which are smaller than a newer value, can never become the maximum
+		while (!m_maxima.empty() && m_maxima.back().value <= value) {
+			m_maxima.popBack();
+		}
+		while (!m_minima.empty() && m_minima.back().value >= value) {
+			m_minima.popBack();
+		}
+		// drop the values leaving the window before adding, so that the queues never overflow
+		if (!m_maxima.empty() && m_maxima.front().position + m_window <= m_position) {
+			m_maxima.popFront();
+		}
+		if (!m_minima.empty() && m_minima.front().position + m_window <= m_position) {
+			m_minima.popFront();
+		}
+		m_maxima.pushBack({ m_position, value });
+		m_minima.pushBack({ m_position, value });
+		m_position++;
+	};
+
+	size_t m_window{ 1 };			// maximum number of values
+	uint64_t m_position{ 0 };		// number of values added
+	Queue m_maxima;					// decreasing values, the maximum first
+	Queue m_minima;					// increasing values, the minimum first
+};
+
+#endif // ROLLINGSTATISTICS_H
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <gsl/gsl>
+#include "alignedBuffer.h"
+
+// Wait-free "latest value" channel between a single producer and a single consumer thread.
+// The producer always has a buffer to write to and the consumer always gets the newest
+// complete buffer, blocks the consumer was too slow for are skipped. Neither side ever waits,
+// so a slow consumer cannot slow down the producer.
+template<class T> class TripleBuffer {
+
+public:
+	TripleBuffer(const int bufferWidth, const int bufferLength);
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	T** getWriteBuffer();
+	void releaseWriteBuffer();
+	// returns nullptr if nothing was published since the last call
+	T** getReadBuffer();
+
+	unsigned int getSkippedBuffers() const;
+
+private:
+	static constexpr uint8_t INDEX_MASK{ 3 };
+	static constexpr uint8_t NEW_DATA{ 4 };		// set if the middle buffer was not read yet
+
+	const int m_bufferWidth;
+	AlignedBuffer<T> m_slab;					// storage of all three buffers, indexed as [buffer][channel][sample]
+	std::vector<T*> m_channels;					// start of every channel in the slab
+	T** m_buffers[3];
+
+	uint8_t m_back{ 0 };						// written by the producer
+	std::atomic<uint8_t> m_middle{ 1 };			// last published buffer
+	uint8_t m_front{ 2 };						// read by the consumer
+	std::atomic<unsigned int> m_skippedBuffers{ 0 };
+};
+
+template<class T>
+inline TripleBuffer<T>::TripleBuffer(const int bufferWidth, const int bufferLength) : m_bufferWidth(bufferWidth) {
+	// pad the channels, so that all of them start on a cache line
+	std::size_t stride = ((bufferLength * sizeof(T) + 63) / 64) * 64 / sizeof(T);
+	m_slab.resize(3 * bufferWidth * stride);
+	m_channels.resize(3 * bufferWidth);
+	for (gsl::index i{ 0 }; i < 3; i++) {
+		m_buffers[i] = &m_channels[i * bufferWidth];
+		for (gsl::index j{ 0 }; j < bufferWidth; j++) {
+			m_buffers[i][j] = &m_slab[(i * bufferWidth + j) * stride];
+		}
+	}
+}
+
+template<class T>
+inline T ** TripleBuffer<T>::getWriteBuffer() {
+	return m_buffers[m_back];
+}
+
+template<class T>
+inline void TripleBuffer<T>::releaseWriteBuffer() {
+	// swap the written buffer with the middle one
+	uint8_t previous = m_middle.exchange(m_back | NEW_DATA, std::memory_order_acq_rel);
+	if (previous & NEW_DATA) {
+		m_skippedBuffers.fetch_add(1, std::memory_order_relaxed);
+	}
+	m_back = previous & INDEX_MASK;
+}
+
+template<class T>
+inline T ** TripleBuffer<T>::getReadBuffer() {
+	if (!(m_middle.load(std::memory_order_relaxed) & NEW_DATA)) {
+		return nullptr;
+	}
+	// swap the read buffer with the newest one
+	uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+	m_front = previous & INDEX_MASK;
+	return m_buffers[m_front];
+}
+
+template<class T>
+inline unsigned int TripleBuffer<T>::getSkippedBuffers() const {
+	return m_skippedBuffers.load(std::memory_order_relaxed);
+}
+#endif //TRIPLEBUFFER_H
\ No newline at end of file
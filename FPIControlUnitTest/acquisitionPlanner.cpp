@@ -0,0 +1,44 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\acquisitionPlanner.h"
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(AcquisitionPlannerTest) {
+		public:
+			TEST_METHOD(TestMethodIntegerPeriods) {
+				// sampling rates of the PS2000 series
+				std::vector<double> samplingRates = { 100e6, 50e6, 25e6, 12.5e6, 6.25e6, 3.125e6, 1.5625e6, 781250, 390625 };
+				// 8 ms blocks at 1.5625 MHz hold 39.0625 periods of 4883 Hz
+				ACQUISITION_PLAN plan = acquisitionPlanner::plan(4883, samplingRates, 8e-3, 8000, 0.01);
+				Assert::IsTrue(plan.integer);
+				Assert::IsTrue(plan.timebaseIndex >= 0);
+				Assert::AreEqual(samplingRates[plan.timebaseIndex], plan.samplingRate);
+				Assert::IsTrue(plan.no_of_samples <= 8000);
+				double periods = plan.no_of_samples * 4883 / plan.samplingRate;
+				Assert::AreEqual(round(periods), periods, 0.01);
+				// the block duration stays close to the target
+				Assert::AreEqual(8e-3, plan.no_of_samples / plan.samplingRate, 2e-3);
+			}
+
+			TEST_METHOD(TestMethodHighestSamplingRate) {
+				// 4000 samples at 1 MHz and 2000 samples at 500 kHz hold exactly 40 periods, 2 MHz needs more samples than available
+				std::vector<double> samplingRates = { 2e6, 1e6, 500e3 };
+				ACQUISITION_PLAN plan = acquisitionPlanner::plan(10e3, samplingRates, 4e-3, 4000, 0.001);
+				Assert::AreEqual(1, plan.timebaseIndex);
+				Assert::AreEqual(uint32_t{ 4000 }, plan.no_of_samples);
+				Assert::AreEqual(40.0, plan.periods, 1e-9);
+				Assert::AreEqual(0.0, plan.leakage, 1e-9);
+			}
+
+			TEST_METHOD(TestMethodUnresolved) {
+				// the modulation is not resolved by any sampling rate
+				std::vector<double> samplingRates = { 1e6 };
+				ACQUISITION_PLAN plan = acquisitionPlanner::plan(400e3, samplingRates, 1e-3, 1000, 0.01);
+				Assert::AreEqual(-1, plan.timebaseIndex);
+				plan = acquisitionPlanner::plan(0, samplingRates, 1e-3, 1000, 0.01);
+				Assert::AreEqual(-1, plan.timebaseIndex);
+			}
+	};
+}
\ No newline at end of file
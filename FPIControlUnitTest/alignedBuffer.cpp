@@ -0,0 +1,39 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\alignedBuffer.h"
+#include <cstdint>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(AlignedBufferTest) {
+		public:
+			TEST_METHOD(TestMethodAligned) {
+				// small buffers are allocated on the heap, large ones are mapped from the operating system
+				for (std::size_t size : { (std::size_t)1000, (std::size_t)1000000 }) {
+					AlignedBuffer<int32_t> buffer(size);
+					Assert::AreEqual(size, buffer.size());
+					Assert::AreEqual((std::uintptr_t)0, reinterpret_cast<std::uintptr_t>(buffer.data()) % 64);
+					buffer[0] = 1;
+					buffer[size - 1] = 2;
+					Assert::AreEqual(1, buffer[0]);
+					Assert::AreEqual(2, buffer[size - 1]);
+				}
+			}
+
+			TEST_METHOD(TestMethodResize) {
+				// the memory is only reallocated if the buffer grows, also from the heap to pages
+				AlignedBuffer<int32_t> buffer(1000);
+				int32_t* data = buffer.data();
+				buffer.resize(10);
+				Assert::IsTrue(data == buffer.data());
+				Assert::AreEqual((std::size_t)10, buffer.span().size());
+				buffer.resize(1000000);
+				Assert::AreEqual((std::size_t)1000000, buffer.size());
+				Assert::AreEqual((std::uintptr_t)0, reinterpret_cast<std::uintptr_t>(buffer.data()) % 64);
+				buffer[999999] = 3;
+				data = buffer.data();
+				buffer.resize(1000);
+				Assert::IsTrue(data == buffer.data());
+			}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\broadcastBuffer.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(BroadcastBufferTest) {
+		public:
+			TEST_METHOD(TestMethodEveryReaderGetsEveryBuffer) {
+				BroadcastBuffer<int> buffer(8, 2);
+				Assert::IsNull(buffer.getReadBuffer(0));
+				for (int value{ 0 }; value < 3; value++) {
+					buffer.getWriteBuffer() = value;
+					buffer.releaseWriteBuffer();
+				}
+				for (gsl::index reader{ 0 }; reader < 2; reader++) {
+					for (int value{ 0 }; value < 3; value++) {
+						const int* read = buffer.getReadBuffer(reader);
+						Assert::IsNotNull(read);
+						Assert::AreEqual(value, *read);
+					}
+					Assert::IsNull(buffer.getReadBuffer(reader));
+					Assert::AreEqual(uint64_t{ 0 }, buffer.getSkippedBuffers(reader));
+				}
+			}
+
+			TEST_METHOD(TestMethodReadNewest) {
+				BroadcastBuffer<int> buffer(8, 2);
+				for (int value{ 0 }; value < 5; value++) {
+					buffer.getWriteBuffer() = value;
+					buffer.releaseWriteBuffer();
+				}
+				Assert::AreEqual(4, *buffer.getReadBuffer(0, READ_POLICY::NEWEST));
+				Assert::AreEqual(uint64_t{ 4 }, buffer.getSkippedBuffers(0));
+				Assert::IsNull(buffer.getReadBuffer(0, READ_POLICY::NEWEST));
+				// the other reader is not affected
+				Assert::AreEqual(0, *buffer.getReadBuffer(1));
+			}
+
+			TEST_METHOD(TestMethodSlowReaderLags) {
+				BroadcastBuffer<int> buffer(4, 2);
+				for (int value{ 0 }; value < 10; value++) {
+					buffer.getWriteBuffer() = value;
+					buffer.releaseWriteBuffer();
+				}
+				// the oldest buffers were overwritten, the reader continues with the oldest remaining one
+				Assert::AreEqual(6, *buffer.getReadBuffer(0));
+				Assert::AreEqual(uint64_t{ 6 }, buffer.getSkippedBuffers(0));
+				Assert::AreEqual(7, *buffer.getReadBuffer(0));
+			}
+
+			TEST_METHOD(TestMethodHeldBufferIsNotOverwritten) {
+				BroadcastBuffer<int> buffer(4, 2);
+				buffer.getWriteBuffer() = 0;
+				buffer.releaseWriteBuffer();
+				const int* read = buffer.getReadBuffer(0);
+				for (int value{ 1 }; value < 10; value++) {
+					buffer.getWriteBuffer() = value;
+					buffer.releaseWriteBuffer();
+				}
+				Assert::AreEqual(0, *read);
+				// the held buffer is still available to the other readers
+				Assert::AreEqual(0, *buffer.getReadBuffer(1));
+				Assert::AreEqual(7, *buffer.getReadBuffer(1));
+				buffer.releaseReadBuffer(0);
+			}
+
+			TEST_METHOD(TestMethodSkipPublished) {
+				BroadcastBuffer<int> buffer(4, 1);
+				buffer.getWriteBuffer() = 0;
+				buffer.releaseWriteBuffer();
+				buffer.skipPublished(0);
+				Assert::IsNull(buffer.getReadBuffer(0));
+				buffer.getWriteBuffer() = 1;
+				buffer.releaseWriteBuffer();
+				Assert::AreEqual(1, *buffer.getReadBuffer(0));
+			}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\cavitySimulation.h"
+#include "..\FPIControl\src\conversion.h"
+#include "..\FPIControl\src\PDH.h"
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(CavitySimulationTest) {
+		public:
+			// acquire a block like the simulated DAQ in the 5 V range and demodulate it like the locking
+			PDH_RESULT demodulate(CavitySimulation& simulation, double outputVoltage) {
+				const uint32_t length{ 1000 };
+				const double samplingRate{ 1e6 };
+				std::vector<int16_t> raw[2] = { std::vector<int16_t>(length), std::vector<int16_t>(length) };
+				simulation.setOutputVoltage(outputVoltage);
+				simulation.simulate(length, samplingRate, [&](uint32_t i, double transmission, double reference) {
+					raw[0][i] = (int16_t)round(std::max(-32767.0, std::min(32767.0, transmission * 32767 / 5000)));
+					raw[1][i] = (int16_t)round(std::max(-32767.0, std::min(32767.0, reference * 32767 / 5000)));
+				});
+				std::vector<int32_t> mv[2] = { std::vector<int32_t>(length), std::vector<int32_t>(length) };
+				for (int ch{ 0 }; ch < 2; ch++) {
+					conversion::adcToMillivolt(raw[ch], mv[ch], 5000);
+				}
+				ReferenceTable table;
+				table.update({ simulation.getParameters().modulationFrequency, 0, samplingRate, length });
+				return PDH::demodulate(mv[0], mv[1], table);
+			}
+
+			TEST_METHOD(TestMethodErrorSignalSign) {
+				SIMULATION_PARAMETERS parameters;
+				parameters.drift = 0;
+				parameters.noise = 0;
+				CavitySimulation simulation(parameters);
+				// the error signal changes its sign at the resonance, a quarter linewidth away it is largest
+				double below = demodulate(simulation, parameters.detuning - 0.005).inPhase;
+				double resonance = demodulate(simulation, parameters.detuning).inPhase;
+				double above = demodulate(simulation, parameters.detuning + 0.005).inPhase;
+				Assert::IsTrue(below > 0);
+				Assert::IsTrue(above < 0);
+				Assert::IsTrue(std::abs(resonance) < 0.1 * below);
+				Assert::IsTrue(std::abs(resonance) < 0.1 * -above);
+			}
+
+			TEST_METHOD(TestMethodNoise) {
+				// the same seed gives the same signals
+				SIMULATION_PARAMETERS parameters;
+				parameters.drift = 0;
+				parameters.seed = 7;
+				CavitySimulation first(parameters);
+				CavitySimulation second(parameters);
+				double below = demodulate(first, parameters.detuning - 0.005).inPhase;
+				Assert::AreEqual(below, demodulate(second, parameters.detuning - 0.005).inPhase);
+				Assert::IsTrue(below > 0);
+				Assert::IsTrue(demodulate(first, parameters.detuning + 0.005).inPhase < 0);
+			}
+
+			TEST_METHOD(TestMethodTrigger) {
+				// every triggered block starts at the rising zero crossing of the reference
+				SIMULATION_PARAMETERS parameters;
+				parameters.noise = 0;
+				parameters.referencePhase = 30;
+				CavitySimulation simulation(parameters);
+				for (uint32_t length : { 1000u, 1234u, 77u }) {
+					simulation.waitForTrigger();
+					double first{ NAN };
+					double second{ NAN };
+					simulation.simulate(length, 1e6, [&](uint32_t i, double, double reference) {
+						if (i == 0) {
+							first = reference;
+						} else if (i == 1) {
+							second = reference;
+						}
+					});
+					Assert::AreEqual(0.0, first, 1e-6);
+					Assert::IsTrue(second > 0);
+				}
+			}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\circularBuffer.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(CircularBufferTest) {
+		public:
+			TEST_METHOD(TestMethodReadInOrder) {
+				CircularBuffer<int> buffer(4, 1, 1);
+				Assert::IsNull(buffer.getReadBuffer());
+				for (int value{ 0 }; value < 3; value++) {
+					buffer.getWriteBuffer()[0][0] = value;
+					buffer.releaseWriteBuffer();
+				}
+				for (int value{ 0 }; value < 3; value++) {
+					int** read = buffer.getReadBuffer();
+					Assert::IsNotNull(read);
+					Assert::AreEqual(value, read[0][0]);
+					buffer.releaseReadBuffer();
+				}
+				Assert::IsNull(buffer.getReadBuffer());
+				Assert::AreEqual(0u, buffer.getDroppedBuffers());
+			}
+
+			TEST_METHOD(TestMethodOverwriteOldest) {
+				CircularBuffer<int> buffer(4, 1, 1, OVERFLOW_POLICY::OVERWRITE_OLDEST);
+				for (int value{ 0 }; value < 6; value++) {
+					buffer.getWriteBuffer()[0][0] = value;
+					buffer.releaseWriteBuffer();
+				}
+				// the two oldest buffers are dropped
+				Assert::AreEqual(2u, buffer.getDroppedBuffers());
+				int** read = buffer.getReadBuffer();
+				Assert::AreEqual(2, read[0][0]);
+				buffer.releaseReadBuffer();
+			}
+
+			TEST_METHOD(TestMethodHeldBufferIsNotOverwritten) {
+				CircularBuffer<int> buffer(4, 1, 1, OVERFLOW_POLICY::OVERWRITE_OLDEST);
+				buffer.getWriteBuffer()[0][0] = 0;
+				buffer.releaseWriteBuffer();
+				int** read = buffer.getReadBuffer();
+				for (int value{ 1 }; value < 4; value++) {
+					buffer.getWriteBuffer()[0][0] = value;
+					buffer.releaseWriteBuffer();
+				}
+				// the ring is full and the next buffer to overwrite is being read
+				Assert::IsNull(buffer.getWriteBuffer());
+				Assert::AreEqual(1u, buffer.getDroppedBuffers());
+				Assert::AreEqual(0, read[0][0]);
+				buffer.releaseReadBuffer();
+				Assert::IsNotNull(buffer.getWriteBuffer());
+			}
+
+			TEST_METHOD(TestMethodAlignedChannels) {
+				// small slabs are allocated on the heap, large ones are mapped from the operating system
+				for (int length : { 1000, 1000000 }) {
+					CircularBuffer<int16_t> buffer(4, 4, length);
+					Assert::IsTrue(buffer.getStride() >= (std::size_t)length);
+					Assert::AreEqual((std::size_t)0, buffer.getStride() * sizeof(int16_t) % 64);
+					for (gsl::index slot{ 0 }; slot < 4; slot++) {
+						for (gsl::index channel{ 0 }; channel < 4; channel++) {
+							int16_t* start = buffer.m_buffers[slot][channel];
+							Assert::AreEqual((std::uintptr_t)0, reinterpret_cast<std::uintptr_t>(start) % 64);
+							Assert::IsTrue(start == buffer.m_buffers[0][0] + buffer.getStride() * (slot * 4 + channel));
+						}
+					}
+				}
+			}
+	};
+}
\ No newline at end of file
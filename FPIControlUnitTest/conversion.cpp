@@ -0,0 +1,47 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\conversion.h"
+#include <gsl/gsl>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(ConversionTest) {
+		public:
+			// Tests for adcToMillivolt()
+			TEST_METHOD(TestMethodAdcToMillivoltAllCounts) {
+				std::vector<int16_t> raw;
+				for (int32_t value{ -32768 }; value <= 32767; value++) {
+					raw.push_back(value);
+				}
+				std::vector<int32_t> mv(raw.size());
+				for (int32_t range : { 10, 50, 5000, 50000 }) {
+					conversion::adcToMillivolt(raw, mv, range);
+					for (gsl::index i{ 0 }; i < (gsl::index)raw.size(); i++) {
+						Assert::AreEqual((raw[i] * range) / 32767, mv[i]);
+					}
+				}
+			}
+
+			TEST_METHOD(TestMethodAdcToMillivoltShort) {
+				std::vector<int16_t> raw = { 32767, -32767, 16384 };
+				std::vector<int32_t> mv(raw.size());
+				conversion::adcToMillivolt(raw, mv, 5000);
+				Assert::AreEqual(5000, mv[0]);
+				Assert::AreEqual(-5000, mv[1]);
+				Assert::AreEqual(2500, mv[2]);
+			}
+
+			// Tests for adcToVolt()
+			TEST_METHOD(TestMethodAdcToVolt) {
+				std::vector<int16_t> raw = { 32767, -32767, 0, 32767, -32767, 0, 32767, -32767, 0 };
+				std::vector<float> volt(raw.size());
+				conversion::adcToVolt(raw, volt, 2000);
+				for (gsl::index i{ 0 }; i < (gsl::index)raw.size(); i += 3) {
+					Assert::AreEqual(2.0f, volt[i], 1e-6f);
+					Assert::AreEqual(-2.0f, volt[i + 1], 1e-6f);
+					Assert::AreEqual(0.0f, volt[i + 2]);
+				}
+			}
+	};
+}
\ No newline at end of file
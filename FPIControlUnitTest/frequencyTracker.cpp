@@ -0,0 +1,57 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\frequencyTracker.h"
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(FrequencyTrackerTest) {
+		public:
+			std::vector<int32_t> cosine(double frequency, double phase, double amplitude, double samplingRate, int length) {
+				std::vector<int32_t> signal(length);
+				for (int i{ 0 }; i < length; i++) {
+					signal[i] = (int32_t)round(amplitude * cos(6.283185307179586 * frequency * i / samplingRate + phase / 360 * 6.283185307179586));
+				}
+				return signal;
+			}
+
+			TEST_METHOD(TestMethodEstimate) {
+				FrequencyTracker tracker;
+				// 5000 Hz nominal, the modulation is off by a third of the resolution of 250 Hz
+				std::vector<int32_t> signal = cosine(5080, 40, 1000, 1e6, 4000);
+				FREQUENCY_ESTIMATE estimate = tracker.update(signal, 5000, 1e6);
+				Assert::AreEqual(5080.0, estimate.frequency, 5);
+				Assert::AreEqual(40.0, estimate.phase, 5);
+				// the interpolation improves once the estimate is centered on the signal
+				estimate = tracker.update(signal, 5000, 1e6);
+				estimate = tracker.update(signal, 5000, 1e6);
+				Assert::AreEqual(5080.0, estimate.frequency, 1.5);
+				Assert::AreEqual(40.0, estimate.phase, 1);
+				Assert::AreEqual(1000.0, estimate.amplitude, 10);
+			}
+
+			TEST_METHOD(TestMethodDrift) {
+				// a drift of several resolutions is followed over some blocks
+				FrequencyTracker tracker;
+				std::vector<int32_t> signal = cosine(5400, -120, 500, 1e6, 4000);
+				for (int i{ 0 }; i < 10; i++) {
+					tracker.update(signal, 5000, 1e6);
+				}
+				Assert::AreEqual(5400.0, tracker.getFrequency(), 1.5);
+				Assert::AreEqual(-120.0, tracker.getEstimate().phase, 1);
+			}
+
+			TEST_METHOD(TestMethodRange) {
+				// a signal far from the nominal frequency is not followed
+				FrequencyTracker tracker;
+				std::vector<int32_t> signal = cosine(8000, 0, 500, 1e6, 4000);
+				for (int i{ 0 }; i < 20; i++) {
+					tracker.update(signal, 5000, 1e6);
+				}
+				Assert::IsTrue(tracker.getFrequency() <= 5500);
+				// changing the nominal frequency resets the estimate
+				signal = cosine(7000, 0, 500, 1e6, 4000);
+				Assert::AreEqual(7000.0, tracker.update(signal, 7000, 1e6).frequency, 2);
+			}
+	};
+}
\ No newline at end of file
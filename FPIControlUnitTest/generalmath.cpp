@@ -199,6 +199,41 @@ namespace FPIControlUnitTest {
 				Assert::AreEqual(2, generalmath::max(vector));
 			}
 
+			TEST_METHOD(TestMethodSpan) {
+				std::array<double, 5> values = { 1.0, 2.0, 3.0, 4.0, 10.0 };
+				gsl::span<const double> span(values);
+				Assert::AreEqual(2.5, generalmath::mean(span.first(4)));
+				Assert::AreEqual(2.5, generalmath::floatingMean(span.first(4), 2, 1));
+				Assert::AreEqual(10.0, generalmath::max(span));
+				Assert::AreEqual(2.0, generalmath::min(span.subspan(1)));
+				Assert::AreEqual(6.0, generalmath::absSum(span.first(3)));
+			}
+
+			// Tests for linspace()
+			TEST_METHOD(TestMethodLinspace) {
+				std::vector<double> vector = generalmath::linspace<double>(0.0, 1.0, 5);
+				Assert::AreEqual(size_t{ 5 }, vector.size());
+				Assert::AreEqual(0.0, vector[0]);
+				Assert::AreEqual(0.25, vector[1]);
+				Assert::AreEqual(1.0, vector[4]);
+			}
+
+			TEST_METHOD(TestMethodLinspaceOutput) {
+				std::vector<double> vector(10);
+				auto data = vector.data();
+				// the storage of the vector is reused
+				generalmath::linspace<double>(-1.0, 1.0, 3, vector);
+				Assert::AreEqual(size_t{ 3 }, vector.size());
+				Assert::IsTrue(data == vector.data());
+				Assert::AreEqual(-1.0, vector[0]);
+				Assert::AreEqual(0.0, vector[1]);
+				Assert::AreEqual(1.0, vector[2]);
+
+				std::array<int, 1> single;
+				generalmath::linspace<int>(4, 8, single);
+				Assert::AreEqual(4, single[0]);
+			}
+
 			TEST_METHOD(TestMethodPrevIndexWrapped) {
 				Assert::AreEqual(gsl::index{ 9 }, generalmath::indexWrapped(-1, 10));
 				Assert::AreEqual(gsl::index{ 0 }, generalmath::indexWrapped(0, 10));
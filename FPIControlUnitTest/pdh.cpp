@@ -0,0 +1,173 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\PDH.h"
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(PDHTest) {
+		public:
+			TEST_METHOD(TestMethodDemodulate) {
+				// compare with normalising the transmission, rotating the reference and averaging the product
+				for (int length{ 1 }; length < 40; length++) {
+					std::vector<int32_t> transmission(length);
+					std::vector<int32_t> reference(length);
+					for (int i{ 0 }; i < length; i++) {
+						transmission[i] = (i * 7919) % 2001 - 1000;
+						reference[i] = (i * 104729) % 301 - 150;
+					}
+					double min = *std::min_element(transmission.begin(), transmission.end());
+					double max = *std::max_element(transmission.begin(), transmission.end());
+					auto expected = [&](int phaseStep) {
+						double error{ 0 };
+						for (int i{ 0 }; i < length; i++) {
+							double normalised = (max != min) ? (transmission[i] - min) / (max - min) : transmission[i];
+							error += normalised * reference[generalmath::indexWrapped(i + phaseStep, length)];
+						}
+						return error / length;
+					};
+					for (int phaseStep{ -2 * length }; phaseStep <= 2 * length; phaseStep += 3) {
+						int quadratureStep = phaseStep + length / 4 + 1;
+						PDH_RESULT result = PDH::demodulate(transmission, reference, phaseStep, quadratureStep);
+						Assert::AreEqual(expected(phaseStep), result.inPhase, 1e-9);
+						Assert::AreEqual(expected(quadratureStep), result.quadrature, 1e-9);
+						Assert::AreEqual(min, result.min);
+						Assert::AreEqual(max, result.max);
+						Assert::AreEqual(size_t(length), result.count);
+					}
+				}
+			}
+
+			TEST_METHOD(TestMethodDemodulateQuadrature) {
+				// ten periods of 40 samples, the transmission lags the reference by 36 degree
+				const int length{ 400 };
+				const int period{ 40 };
+				std::vector<int32_t> transmission(length);
+				std::vector<int32_t> reference(length);
+				for (int i{ 0 }; i < length; i++) {
+					transmission[i] = (int32_t)round(1000 + 500 * cos((360.0 * i / period - 36) * PDH_DEGREE));
+					reference[i] = (int32_t)round(1000 * cos(360.0 * i / period * PDH_DEGREE));
+				}
+				PDH_RESULT result = PDH::demodulate(transmission, reference, 0, period / 4);
+				Assert::AreEqual(-36.0, result.phase(), 0.1);
+				Assert::AreEqual(250.0, result.magnitude(), 1);
+				// the error signal at any phase equals shifting the reference by the same phase
+				for (int phaseStep{ -period }; phaseStep <= period; phaseStep += 3) {
+					PDH_RESULT shifted = PDH::demodulate(transmission, reference, phaseStep, phaseStep);
+					Assert::AreEqual(shifted.inPhase, result.error(360.0 * phaseStep / period), 0.5);
+				}
+			}
+
+			TEST_METHOD(TestMethodDemodulateTable) {
+				// 12.5 samples per period, so the phase of the measured reference cannot be shifted by whole samples
+				const int length{ 500 };
+				const double samplesPerPeriod{ 12.5 };
+				std::vector<int32_t> transmission(length);
+				std::vector<int32_t> reference(length);
+				for (int i{ 0 }; i < length; i++) {
+					double angle = 360.0 * i / samplesPerPeriod + 17;
+					transmission[i] = (int32_t)round(1000 + 500 * cos((angle - 41.3) * PDH_DEGREE));
+					reference[i] = (int32_t)round(1000 * cos(angle * PDH_DEGREE));
+				}
+				double min = *std::min_element(transmission.begin(), transmission.end());
+				double max = *std::max_element(transmission.begin(), transmission.end());
+				ReferenceTable table;
+				// the result does not depend on the phase of the table
+				for (double phase : { 0.0, 123.4 }) {
+					table.update({ 4000, phase, 50000, length });
+					PDH_RESULT result = PDH::demodulate(transmission, reference, table);
+					Assert::AreEqual(-41.3, result.phase(), 0.1);
+					Assert::AreEqual(1000 * 500 / (max - min) / 2, result.magnitude(), 1);
+					Assert::AreEqual(min, result.min);
+					Assert::AreEqual(max, result.max);
+				}
+			}
+
+			TEST_METHOD(TestMethodDemodulateTableSegments) {
+				// every segment starts with another phase of the modulation
+				const int segmentLength{ 100 };
+				std::vector<int32_t> transmission(3 * segmentLength + 40);
+				std::vector<int32_t> reference(transmission.size());
+				for (gsl::index i{ 0 }; i < (gsl::index)transmission.size(); i++) {
+					double angle = 360.0 * (i % segmentLength) / 20 + 70.0 * (i / segmentLength);
+					transmission[i] = (int32_t)round(1000 + 1000 * cos((angle + 60) * PDH_DEGREE));
+					reference[i] = (int32_t)round(1000 * cos(angle * PDH_DEGREE));
+				}
+				ReferenceTable table;
+				table.update({ 1000, 0, 20000, segmentLength });
+				PDH_RESULT result = PDH::demodulate(transmission, reference, table);
+				Assert::AreEqual(60.0, result.phase(), 0.1);
+				Assert::AreEqual(250.0, result.magnitude(), 1);
+				Assert::AreEqual(0.0, result.error(150), 1);
+			}
+
+			TEST_METHOD(TestMethodDemodulateWindowed) {
+				// 10.37 periods per block, the partial period leaks into the phasors without a window
+				const int length{ 500 };
+				const double frequency{ 10.37 };
+				std::vector<int32_t> transmission(length);
+				std::vector<int32_t> reference(length);
+				for (int i{ 0 }; i < length; i++) {
+					double angle = 360.0 * frequency * i / length;
+					transmission[i] = (int32_t)round(1000 + 500 * cos((angle - 41.3) * PDH_DEGREE));
+					reference[i] = (int32_t)round(1000 * cos(angle * PDH_DEGREE));
+				}
+				ReferenceTable table;
+				table.update({ frequency, 0, length, length, false });
+				double leakage = std::abs(PDH::demodulate(transmission, reference, table).phase() + 41.3);
+				table.update({ frequency, 0, length, length, true });
+				PDH_RESULT result = PDH::demodulate(transmission, reference, table);
+				Assert::AreEqual(-41.3, result.phase(), 0.2);
+				Assert::IsTrue(std::abs(result.phase() + 41.3) < leakage);
+			}
+
+			TEST_METHOD(TestMethodDemodulateReferenceFree) {
+				// triggered acquisition, every segment starts at the same phase of the reference,
+				// the last segment is shorter but holds an integer number of periods as well
+				const int segmentLength{ 100 };
+				const double samplesPerPeriod{ 12.5 };
+				std::vector<int32_t> transmission(3 * segmentLength + 50);
+				std::vector<int32_t> reference(transmission.size());
+				for (gsl::index i{ 0 }; i < (gsl::index)transmission.size(); i++) {
+					double angle = 360.0 * (i % segmentLength) / samplesPerPeriod + 17;
+					transmission[i] = (int32_t)round(1000 + 500 * cos((angle - 41.3) * PDH_DEGREE));
+					reference[i] = (int32_t)round(800 * cos(angle * PDH_DEGREE));
+				}
+				ReferenceTable table;
+				table.update({ 4000, 0, 50000, segmentLength });
+				PDH_RESULT expected = PDH::demodulate(transmission, reference, table);
+				// the synthesised reference has the phase of the measured one at the trigger
+				table.update({ 4000, 17, 50000, segmentLength });
+				PDH_RESULT result = PDH::demodulate(transmission, table, 800);
+				Assert::AreEqual(expected.inPhase, result.inPhase, 0.5);
+				Assert::AreEqual(expected.quadrature, result.quadrature, 0.5);
+				Assert::AreEqual(-41.3, result.phase(), 0.1);
+				Assert::AreEqual(expected.min, result.min);
+				Assert::AreEqual(expected.max, result.max);
+				Assert::AreEqual(expected.sum, result.sum);
+				Assert::AreEqual(transmission.size(), result.count);
+			}
+
+			TEST_METHOD(TestMethodDemodulateSum) {
+				std::vector<int32_t> transmission = { 2, 4, 6, 8, 10 };
+				std::vector<int32_t> reference = { 1, -1, 1, -1, 1 };
+				PDH_RESULT result = PDH::demodulate(transmission, reference, 0, 0);
+				Assert::AreEqual(30.0, result.sum);
+				Assert::AreEqual(8.0, result.amplitude());
+				// normalised transmission 0, 0.25, 0.5, 0.75, 1
+				Assert::AreEqual(0.1, result.inPhase, 1e-12);
+			}
+
+			TEST_METHOD(TestMethodDemodulateEmpty) {
+				PDH_RESULT result = PDH::demodulate(gsl::span<const int32_t>(), gsl::span<const int32_t>(), 3, 5);
+				Assert::AreEqual(size_t{ 0 }, result.count);
+				Assert::IsTrue(isnan(result.inPhase));
+				Assert::IsTrue(isnan(result.quadrature));
+				ReferenceTable table;
+				table.update({ 4000, 0, 50000, 100 });
+				result = PDH::demodulate(gsl::span<const int32_t>(), table, 800);
+				Assert::AreEqual(size_t{ 0 }, result.count);
+				Assert::IsTrue(isnan(result.inPhase));
+			}
+	};
+}
\ No newline at end of file
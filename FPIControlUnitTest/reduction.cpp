@@ -0,0 +1,59 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\reduction.h"
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(ReductionTest) {
+		public:
+			TEST_METHOD(TestMethodReduceStatsInt16) {
+				std::vector<int16_t> values = { -32767, 5, -3, 32767, 100, -100, 7, 0, 1, -2, 3 };
+				REDUCE_STATS stats = reduction::reduceStats(values);
+				Assert::AreEqual(size_t{ 11 }, stats.count);
+				Assert::AreEqual(-32767.0, stats.min);
+				Assert::AreEqual(32767.0, stats.max);
+				Assert::AreEqual(11.0, stats.sum);
+				Assert::AreEqual(65755.0, stats.absSum);
+				Assert::AreEqual(2.0 * 32767 * 32767 + 20097, stats.sumSquares);
+			}
+
+			TEST_METHOD(TestMethodReduceStatsInt32) {
+				// compare with a scalar calculation for all lengths around the vector width
+				for (int length{ 1 }; length < 40; length++) {
+					std::vector<int32_t> values(length);
+					double sum{ 0 }, absSum{ 0 }, sumSquares{ 0 };
+					for (int i{ 0 }; i < length; i++) {
+						values[i] = (i * 7919) % 2001 - 1000;
+						sum += values[i];
+						absSum += abs(values[i]);
+						sumSquares += (double)values[i] * values[i];
+					}
+					REDUCE_STATS stats = reduction::reduceStats(values);
+					Assert::AreEqual((double)*std::min_element(values.begin(), values.end()), stats.min);
+					Assert::AreEqual((double)*std::max_element(values.begin(), values.end()), stats.max);
+					Assert::AreEqual(sum, stats.sum);
+					Assert::AreEqual(absSum, stats.absSum);
+					Assert::AreEqual(sumSquares, stats.sumSquares);
+				}
+			}
+
+			TEST_METHOD(TestMethodReduceStatsFloat) {
+				std::vector<float> values = { 0.5f, -1.5f, 2.0f, -0.25f, 1.0f };
+				REDUCE_STATS stats = reduction::reduceStats(values);
+				Assert::AreEqual(-1.5, stats.min);
+				Assert::AreEqual(2.0, stats.max);
+				Assert::AreEqual(1.75, stats.sum);
+				Assert::AreEqual(5.25, stats.absSum);
+				Assert::AreEqual(7.5625, stats.sumSquares);
+				Assert::AreEqual(0.35, stats.mean(), 1e-12);
+			}
+
+			TEST_METHOD(TestMethodReduceStatsEmpty) {
+				REDUCE_STATS stats = reduction::reduceStats(gsl::span<const int32_t>());
+				Assert::AreEqual(size_t{ 0 }, stats.count);
+				Assert::IsTrue(isnan(stats.min));
+				Assert::IsTrue(isnan(stats.max));
+			}
+	};
+}
\ No newline at end of file
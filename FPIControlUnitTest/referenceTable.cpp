@@ -0,0 +1,62 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\referenceTable.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(ReferenceTableTest) {
+		public:
+			TEST_METHOD(TestMethodValues) {
+				ReferenceTable table;
+				// 12.5 samples per period and a phase of a fifth of a sample
+				Assert::IsTrue(table.update({ 4000, 5.76, 50000, 1000 }));
+				Assert::AreEqual(size_t{ 1000 }, table.size());
+				for (gsl::index i{ 0 }; i < 1000; i += 37) {
+					double angle = 6.283185307179586 * (i / 12.5 + 0.016);
+					Assert::AreEqual(cos(angle), (double)table.cosine()[i], 1e-6);
+					Assert::AreEqual(sin(angle), (double)table.sine()[i], 1e-6);
+				}
+				// the table holds 80 whole periods
+				Assert::AreEqual(0.0, abs(table.mean(1000)), 1e-6);
+			}
+
+			TEST_METHOD(TestMethodCaching) {
+				ReferenceTable table;
+				REFERENCE_PARAMETERS parameters{ 5000, 90, 1e6, 200 };
+				Assert::IsTrue(table.update(parameters));
+				Assert::IsFalse(table.update(parameters));
+				parameters.phase = 90.5;
+				Assert::IsTrue(table.update(parameters));
+				parameters.no_of_samples = 100;
+				Assert::IsTrue(table.update(parameters));
+				Assert::AreEqual(size_t{ 100 }, table.size());
+				Assert::IsFalse(table.update(parameters));
+			}
+
+			TEST_METHOD(TestMethodWindow) {
+				ReferenceTable table;
+				// 10.37 periods, the window suppresses the mean of the partial period
+				table.update({ 10.37, 0, 1000, 1000, false });
+				double mean = std::abs(table.mean(1000));
+				Assert::IsTrue(table.update({ 10.37, 0, 1000, 1000, true }));
+				Assert::IsTrue(std::abs(table.mean(1000)) < mean / 10);
+				// the window is scaled to a mean of one
+				double sum{ 0 };
+				for (gsl::index i{ 0 }; i < 1000; i++) {
+					sum += table.cosine()[i] * table.cosine()[i] + table.sine()[i] * table.sine()[i];
+				}
+				Assert::AreEqual(1.5, sum / 1000, 1e-3);
+			}
+
+			TEST_METHOD(TestMethodMean) {
+				ReferenceTable table;
+				table.update({ 1000, 30, 7000, 50 });
+				std::complex<double> sum{ 0 };
+				for (gsl::index i{ 0 }; i < 20; i++) {
+					sum += std::complex<double>(table.cosine()[i], -table.sine()[i]);
+				}
+				Assert::AreEqual((sum / 20.0).real(), table.mean(20).real(), 1e-12);
+				Assert::AreEqual((sum / 20.0).imag(), table.mean(20).imag(), 1e-12);
+			}
+	};
+}
\ No newline at end of file
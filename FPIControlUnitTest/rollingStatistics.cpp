@@ -0,0 +1,79 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\rollingStatistics.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(RollingStatisticsTest) {
+		public:
+			TEST_METHOD(TestMethodEmpty) {
+				RollingStatistics statistics(10);
+				Assert::IsTrue(isnan(statistics.mean()));
+				Assert::IsTrue(isnan(statistics.standardDeviation()));
+			}
+
+			TEST_METHOD(TestMethodWrappedRing) {
+				// compare with the recalculation over the last values of a wrapping ring
+				std::vector<double> history(7);
+				RollingStatistics statistics(4);
+				gsl::index index{ 0 };
+				size_t count{ 0 };
+				for (int value{ 0 }; value < 20; value++) {
+					history[index] = (value * value) % 11;
+					count = std::min(count + 1, history.size());
+					statistics.update(history, index, count);
+					index = (index + 1) % history.size();
+					if (count >= 4) {
+						size_t offset = history.size() - index;
+						Assert::AreEqual(generalmath::floatingMean(history, 4, offset), statistics.mean(), 1e-12);
+						Assert::AreEqual(generalmath::floatingStandardDeviation(history, 4, offset), statistics.standardDeviation(), 1e-12);
+					}
+				}
+				Assert::AreEqual(size_t{ 4 }, statistics.size());
+			}
+
+			TEST_METHOD(TestMethodSetWindow) {
+				std::vector<double> history = { 1.0, 2.0, 3.0, 4.0, 5.0, 0.0 };
+				RollingStatistics statistics;
+				// five values are stored, the newest one at index 4
+				statistics.setWindow(3, history, 4, 5);
+				Assert::AreEqual(4.0, statistics.mean());
+				Assert::AreEqual(1.0, statistics.standardDeviation());
+				// the window is longer than the stored values
+				statistics.setWindow(10, history, 4, 5);
+				Assert::AreEqual(size_t{ 5 }, statistics.size());
+				Assert::AreEqual(3.0, statistics.mean());
+			}
+
+			TEST_METHOD(TestMethodSlidingExtrema) {
+				// compare with the recalculation over the last values of a wrapping ring
+				std::vector<int32_t> history(7);
+				SlidingExtrema<int32_t> extrema(4);
+				gsl::index index{ 0 };
+				for (int value{ 0 }; value < 40; value++) {
+					history[index] = (value * 7) % 11 - 5;
+					extrema.update(history, index);
+					std::vector<int32_t> window;
+					for (int i{ 0 }; i < (int)extrema.size(); i++) {
+						window.push_back(history[generalmath::indexWrapped((int)index - i, (int)history.size())]);
+					}
+					Assert::AreEqual(*std::max_element(window.begin(), window.end()), extrema.max());
+					Assert::AreEqual(*std::min_element(window.begin(), window.end()), extrema.min());
+					index = (index + 1) % history.size();
+				}
+				Assert::AreEqual(size_t{ 4 }, extrema.size());
+			}
+
+			TEST_METHOD(TestMethodSlidingExtremaSetWindow) {
+				std::vector<int32_t> history = { 9, 1, 5, 3, 0, 0 };
+				SlidingExtrema<int32_t> extrema;
+				// four values are stored, the newest one at index 3
+				extrema.setWindow(3, history, 3, 4);
+				Assert::AreEqual(5, extrema.max());
+				Assert::AreEqual(1, extrema.min());
+				extrema.setWindow(10, history, 3, 4);
+				Assert::AreEqual(size_t{ 4 }, extrema.size());
+				Assert::AreEqual(9, extrema.max());
+			}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "stdafx.h"
+#include "..\FPIControl\src\tripleBuffer.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(TripleBufferTest) {
+		public:
+			TEST_METHOD(TestMethodReadNewest) {
+				TripleBuffer<int> buffer(2, 10);
+				Assert::IsNull(buffer.getReadBuffer());
+				for (int value{ 0 }; value < 5; value++) {
+					int** write = buffer.getWriteBuffer();
+					write[0][0] = value;
+					write[1][9] = -value;
+					buffer.releaseWriteBuffer();
+				}
+				int** read = buffer.getReadBuffer();
+				Assert::IsNotNull(read);
+				Assert::AreEqual(4, read[0][0]);
+				Assert::AreEqual(-4, read[1][9]);
+				Assert::AreEqual(4u, buffer.getSkippedBuffers());
+				// nothing new was published
+				Assert::IsNull(buffer.getReadBuffer());
+			}
+
+			TEST_METHOD(TestMethodReadBufferIsNotOverwritten) {
+				TripleBuffer<int> buffer(1, 1);
+				buffer.getWriteBuffer()[0][0] = 1;
+				buffer.releaseWriteBuffer();
+				int** read = buffer.getReadBuffer();
+				for (int value{ 2 }; value < 10; value++) {
+					buffer.getWriteBuffer()[0][0] = value;
+					buffer.releaseWriteBuffer();
+				}
+				Assert::AreEqual(1, read[0][0]);
+				Assert::AreEqual(9, buffer.getReadBuffer()[0][0]);
+			}
+	};
+}
\ No newline at end of file